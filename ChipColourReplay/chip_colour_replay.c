@@ -0,0 +1,209 @@
+/* ////////////////////////////////////////////////////////////////////////////
+// PC Program:    CMPE2965 - Poker Chip Sorter Colour Sensor Replay
+// Author:        Andrew Belter
+// Details:       Replays recorded colour sensor readings (the SCI0 stream from the Operation
+//                project with the sensor colour provider selected) through the same TCS34725
+//                driver and ChipColour library the board uses, and checks each verdict against
+//                the recording. The driver talks to a stand-in for i2c.c below, which acts as a
+//                TCS34725 serving the recorded channel counts.
+//                Build and run on a PC:
+//                  gcc -I../lib -o chip_colour_replay chip_colour_replay.c ../lib/TCS34725.c ../lib/ChipColour.c
+//                  chip_colour_replay <recording.txt>
+// Date:          Oct. 19, 2026
+/////////////////////////////////////////////////////////////////////////// */
+#include <stdio.h>
+
+#include "i2c.h"
+#include "TCS34725.h"
+#include "ChipColour.h"
+
+// recording line formats (one per line, \r\n terminated):
+//  W,<clear>,<red>,<green>,<blue>           - white reference the board was calibrated with
+//  C,<clear>,<red>,<green>,<blue>,<code>    - chip reading and the board's colour byte
+
+/////////////////////////////////////////////////////////////////////////////
+// I2C stand-in - a TCS34725 register file behind the i2c.h API
+/////////////////////////////////////////////////////////////////////////////
+
+unsigned char SensorRegisters[32];
+unsigned char SensorPointer = 0;      // register the next byte is read from or written to
+unsigned char SensorAddressed = 0;    // 1 = the last address byte was for the sensor
+unsigned char SensorExpectCommand = 0; // 1 = the next byte written is a command byte
+
+void I2C_Init0(I2C_MicroBusRate eBus, I2C_BusRate eRate, int IntsOn)
+{
+    (void)eBus;
+    (void)eRate;
+    (void)IntsOn;
+}
+
+int I2C_SendAddressRW(unsigned char address, unsigned char IsRead, unsigned char WaitForBus)
+{
+    (void)WaitForBus;
+    SensorAddressed = address == TCS34725ADDR;
+    SensorExpectCommand = !IsRead;
+    return SensorAddressed ? 0 : -1; // no ACK from anything else
+}
+
+int I2C_WriteByte(unsigned char val, unsigned char IssueStop)
+{
+    (void)IssueStop;
+    if (SensorExpectCommand)
+    {
+        // command byte - select the register
+        SensorPointer = val & 0x1F;
+        SensorExpectCommand = 0;
+        return 0;
+    }
+    SensorRegisters[SensorPointer++ & 0x1F] = val;
+    return 0;
+}
+
+int I2C_RXByte(unsigned char *buff, unsigned char IssueAck, unsigned char IssueStop)
+{
+    (void)IssueAck;
+    (void)IssueStop;
+    *buff = SensorRegisters[SensorPointer++ & 0x1F];
+    return 0;
+}
+
+void I2C_IssueRestart(void)
+{
+}
+
+// runs the whole transaction at once, as if the ISR had already completed it
+int I2C_Queue(I2C_Transaction *pXfer)
+{
+    unsigned char i;
+
+    if (pXfer->status == I2C_Status_Pending || (!pXfer->writeCount && !pXfer->readCount))
+        return -1;
+
+    if (I2C_SendAddressRW(pXfer->address, I2C_WRITE, I2C_WAIT))
+    {
+        pXfer->status = I2C_Status_Error;
+        return 0;
+    }
+    for (i = 0; i < pXfer->writeCount; ++i)
+        (void)I2C_WriteByte(pXfer->pWrite[i], i + 1 == pXfer->writeCount && !pXfer->readCount);
+    for (i = 0; i < pXfer->readCount; ++i)
+        (void)I2C_RXByte(pXfer->pRead + i, i + 1 < pXfer->readCount, i + 1 == pXfer->readCount);
+
+    pXfer->status = I2C_Status_Done;
+    return 0;
+}
+
+// transactions complete inside I2C_Queue, so none is ever left waiting for the bus
+void I2C_QueueRetry(void)
+{
+}
+
+// loads a reading into the sensor's data registers (low byte first) and flags it valid
+void SensorLoad(ChipColour_Reading const *pReading)
+{
+    unsigned int const channels[4] = {pReading->clear, pReading->red, pReading->green, pReading->blue};
+    unsigned char i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        SensorRegisters[0x14 + 2 * i] = (unsigned char)channels[i];
+        SensorRegisters[0x15 + 2 * i] = (unsigned char)(channels[i] >> 8);
+    }
+    SensorRegisters[0x13] |= 0x01; // STATUS - AVALID
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Replay
+/////////////////////////////////////////////////////////////////////////////
+
+// reads the reading back through the driver, as the board does, and classifies it
+// returns the category, or -1 if the driver failed
+int ReadAndClassify(ChipColour_Reading *pReading)
+{
+    unsigned char raw[TCS34725_READ_BYTES];
+
+    if (TCS34725_StartRead(raw) || TCS34725_ReadStatus())
+        return -1;
+    if (TCS34725_Unpack(raw, &pReading->clear, &pReading->red, &pReading->green, &pReading->blue))
+        return -1;
+    return ChipColour_ClassifyReading(pReading);
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *pFile;
+    char line[128];
+    unsigned int counts[ChipColour_None + 1] = {0};
+    unsigned int readings = 0;
+    int mismatches = 0;
+    unsigned int i;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <recording.txt>\n", argv[0]);
+        return 2;
+    }
+
+    pFile = fopen(argv[1], "r");
+    if (!pFile)
+    {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return 2;
+    }
+
+    // the board's startup sequence against the stand-in
+    SensorRegisters[0x12] = 0x44; // ID - TCS34725
+    I2C_Init0(I2CMicro20MHz, I2CBus400, 0);
+    if (TCS34725_Init(TCS34725_IntTime_24ms, TCS34725_Gain_4x) || TCS34725_Enable())
+    {
+        fprintf(stderr, "sensor init failed\n");
+        fclose(pFile);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), pFile))
+    {
+        ChipColour_Reading reading;
+        char code;
+        int category;
+
+        if (sscanf(line, "W,%u,%u,%u,%u", &reading.clear, &reading.red, &reading.green, &reading.blue) == 4)
+        {
+            ChipColour_SetWhite(&reading);
+            printf("white reference %u %u %u %u\n", reading.clear, reading.red, reading.green, reading.blue);
+            continue;
+        }
+        if (sscanf(line, "C,%u,%u,%u,%u,%c", &reading.clear, &reading.red, &reading.green, &reading.blue, &code) != 5)
+            continue;
+
+        SensorLoad(&reading);
+        category = ReadAndClassify(&reading);
+        if (category < 0)
+        {
+            fprintf(stderr, "reading %u: driver read failed\n", readings);
+            fclose(pFile);
+            return 1;
+        }
+        ++counts[category];
+
+        if (ChipColour_Code((ChipColour_Category)category) != (unsigned char)code)
+        {
+            ChipColour_HSV hsv = ChipColour_ToHSV(&reading);
+
+            printf("reading %u: %u %u %u %u -> hsv %u %u %u %s (%c), board sent %c\n", readings, reading.clear,
+                   reading.red, reading.green, reading.blue, hsv.hue, hsv.sat, hsv.val,
+                   ChipColour_Name((ChipColour_Category)category), ChipColour_Code((ChipColour_Category)category), code);
+            ++mismatches;
+        }
+        ++readings;
+    }
+    fclose(pFile);
+
+    for (i = 0; i <= ChipColour_None; ++i)
+    {
+        if (counts[i])
+            printf("%-7s %u\n", ChipColour_Name((ChipColour_Category)i), counts[i]);
+    }
+    printf("%u readings, %d mismatch(es)\n", readings, mismatches);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This program benchmarks the colour detection pipeline over a directory of labelled chip images, without hardware.
+Images are labelled by their folder (images/blue/chip01.jpg) or by their filename prefix (images/blue_chip01.jpg),
+using the category names from colour_detection. Unlabelled images are timed but left out of the accuracy results.
+It reports per-stage latency percentiles, throughput and a confusion matrix.
+Usage: python benchmark.py <image directory> [--repeat N] [--tables colour_tables.json]
+"""
+import argparse
+import os
+import time
+
+import cv2
+import numpy as np
+
+import colour_detection as cd
+
+IMAGE_EXTENSIONS = (".jpg", ".jpeg", ".png", ".bmp")
+PERCENTILES = (50, 90, 99)
+
+
+def image_label(path, root):
+    """
+    Gets the label of an image from its folder name or filename prefix.
+    :param path: the image path
+    :param root: the image directory being benchmarked
+    :return: the category name, or None if the image is unlabelled
+    """
+    folder = os.path.basename(os.path.dirname(os.path.relpath(path, root)))
+    if folder.lower() in cd.CATEGORIES:
+        return folder.lower()
+
+    prefix = os.path.basename(path).split("_")[0].split(".")[0].lower()
+    return prefix if prefix in cd.CATEGORIES else None
+
+
+def find_images(root):
+    """
+    :return: sorted list of (path, label) for every image under root
+    """
+    images = []
+    for folder, _, files in os.walk(root):
+        for name in files:
+            if name.lower().endswith(IMAGE_EXTENSIONS):
+                path = os.path.join(folder, name)
+                images.append((path, image_label(path, root)))
+    return sorted(images)
+
+
+def timed(stage_times, stage, function, *args):
+    """
+    Runs function(*args), adding its latency in ms to stage_times[stage].
+    :return: the function result
+    """
+    start = time.perf_counter()
+    result = function(*args)
+    stage_times.setdefault(stage, []).append((time.perf_counter() - start) * 1e3)
+    return result
+
+
+def positive_int(text):
+    """
+    argparse type for a count of at least 1.
+    """
+    value = int(text)
+    if value < 1:
+        raise argparse.ArgumentTypeError(f"must be at least 1, not {value}")
+    return value
+
+
+def print_latencies(stage_times):
+    print(f"{'stage':<28}" + "".join(f"{'p' + str(p):>9}" for p in PERCENTILES) + f"{'max':>9}{'mean':>9}  (ms)")
+    for stage, times in stage_times.items():
+        values = np.percentile(times, PERCENTILES)
+        print(f"{stage:<28}" + "".join(f"{value:9.3f}" for value in values) + f"{max(times):9.3f}{np.mean(times):9.3f}")
+
+
+def print_confusion(results):
+    """
+    Prints the confusion matrix and accuracy of the labelled results.
+    :param results: list of (label, verdict) for every labelled image
+    """
+    if not results:
+        print("no labelled images - accuracy not measured")
+        return
+
+    index = {name: i for i, name in enumerate(cd.CATEGORIES)}
+    matrix = np.zeros((len(cd.CATEGORIES), len(cd.CATEGORIES)), dtype=int)
+    for label, verdict in results:
+        matrix[index[label], index[verdict]] += 1
+
+    width = max(len(name) for name in cd.CATEGORIES) + 2
+    print("confusion matrix (rows: label, columns: verdict)")
+    print(" " * width + "".join(f"{name:>{width}}" for name in cd.CATEGORIES))
+    for name, row in zip(cd.CATEGORIES, matrix):
+        if row.sum():
+            print(f"{name:<{width}}" + "".join(f"{count:>{width}}" for count in row))
+
+    correct = int(np.trace(matrix))
+    print(f"accuracy: {correct}/{len(results)} ({correct / len(results):.1%})")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmark colour detection over labelled chip images.")
+    parser.add_argument("directory", help="directory of chip images, labelled by folder or filename prefix")
+    parser.add_argument("--repeat", type=positive_int, default=5, help="times each image is analysed, for stable latencies")
+    parser.add_argument("--tables", help="colour table config to classify with (see colour_tables.example.json), "
+                                         "to check a retune before loading it into the service")
+    args = parser.parse_args()
+
+    if args.tables is not None:
+        cd.install_tables(cd.load_tables(args.tables))
+
+    images = find_images(args.directory)
+    if not images:
+        raise SystemExit(f"no images found in {args.directory}")
+
+    stage_times = {}
+    pipeline_times = []
+    results = []        # (label, verdict) of the reference pipeline, for the labelled images
+    disagreements = 0   # images where the progressive sampler decides differently from the reference pipeline
+
+    for path, label in images:
+        img = cv2.imread(path)
+        if img is None:
+            print(f"could not read {path}, skipped")
+            continue
+
+        # warm up the per image size caches, so the first repeat is not timed with them
+        cd.categorize_pixels(cd.convert_and_scan(img))
+        cd.classify_ring_progressive(img)
+
+        for repeat in range(args.repeat):
+            # the reference pipeline, timed per stage
+            start = time.perf_counter()
+            pixels = timed(stage_times, "convert_and_scan", cd.convert_and_scan, img)
+            categories = timed(stage_times, "categorize_pixels", cd.categorize_pixels, pixels)
+            verdict = timed(stage_times, "analyse_categories", cd.analyse_categories, categories)
+            pipeline_times.append(time.perf_counter() - start)
+
+            # the single call classifiers used by the service
+            timed(stage_times, "classify_ring", cd.classify_ring, img)
+            progressive = timed(stage_times, "classify_ring_progressive", cd.classify_ring_progressive, img)
+
+        if cd.analyse_categories(progressive) != verdict:
+            disagreements += 1
+        if label is not None:
+            results.append((label, verdict))
+
+    print(f"{len(images)} images ({len(results)} labelled), {args.repeat} repeats, "
+          f"native kernel {'built' if cd.ring_kernel is not None else 'not built'}")
+    print_latencies(stage_times)
+    print(f"pipeline throughput: {len(pipeline_times) / sum(pipeline_times):.1f} images/s")
+    print(f"progressive sampler disagreements with the full ring: {disagreements}")
+    print()
+    print_confusion(results)
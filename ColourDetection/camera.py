@@ -0,0 +1,164 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the camera configuration layer used by the vision service.
+It opens a camera with the platform's native capture backend (V4L2 on Linux, DirectShow on Windows)
+and applies the capture settings, or opens a stand-in image/video source so capture can be tested without a webcam.
+"""
+import os
+import sys
+import time
+from dataclasses import dataclass
+from typing import Optional, Union
+
+import cv2
+
+IMAGE_EXTENSIONS = (".jpg", ".jpeg", ".png", ".bmp")
+
+
+@dataclass
+class CameraConfig:
+    """
+    Capture settings. None leaves a setting at the driver default.
+    The ring pattern is measured in pixels from the image center (see colour_detection.RingGeometry),
+    so the resolution must stay large enough to hold it - 640x480 is what it was calibrated at.
+    """
+    device: Union[int, str] = 0         # camera index, or a video file, image file or image directory to stand in
+    backend: str = "auto"               # "auto" picks by platform, or "v4l2", "dshow", "msmf", "any"
+    width: Optional[int] = 640
+    height: Optional[int] = 480
+    fps: Optional[float] = 30
+    fourcc: Optional[str] = "MJPG"      # "MJPG" keeps USB bandwidth low at high frame rates, "YUYV" avoids decoding
+    exposure: Optional[float] = None    # fixed exposure in driver units, None keeps auto exposure
+    white_balance: Optional[int] = None # fixed white balance temperature in K, None keeps auto white balance
+    buffer_size: Optional[int] = 1      # frames queued by the driver, 1 keeps the latest frame current
+    source_fps: float = 30              # frame rate a stand-in image source is paced at, 0 for as fast as possible
+
+
+BACKENDS = {
+    "v4l2": cv2.CAP_V4L2,
+    "dshow": cv2.CAP_DSHOW,
+    "msmf": cv2.CAP_MSMF,
+    "any": cv2.CAP_ANY,
+}
+
+
+def platform_backend():
+    """
+    :return: the OpenCV capture backend native to this platform
+    """
+    if sys.platform.startswith("linux"):
+        return cv2.CAP_V4L2
+    if sys.platform == "win32":
+        return cv2.CAP_DSHOW
+    return cv2.CAP_ANY
+
+
+class ImageSource:
+    """
+    Stands in for a camera by serving an image file, or every image in a directory in name order, repeatedly.
+    Has the VideoCapture methods the vision service uses, and is paced like a camera so readers do not spin.
+    """
+
+    def __init__(self, path, fps=30):
+        """
+        :param path: an image file or a directory of images
+        :param fps: the frame rate to serve at, 0 for as fast as possible
+        """
+        if os.path.isdir(path):
+            names = sorted(name for name in os.listdir(path) if name.lower().endswith(IMAGE_EXTENSIONS))
+            paths = [os.path.join(path, name) for name in names]
+        else:
+            paths = [path]
+
+        # decode once up front, so serving a frame costs what a camera read would
+        self._frames = [img for img in (cv2.imread(p) for p in paths) if img is not None]
+        self._interval = 1 / fps if fps else 0
+        self._next = 0
+        self._due = time.monotonic()
+
+    def isOpened(self):
+        return bool(self._frames)
+
+    def read(self):
+        """
+        Waits for the next frame time and returns the next image, as VideoCapture.read does.
+        :return: Tuple of (True, image), or (False, None) if there are no images
+        """
+        if not self._frames:
+            return False, None
+
+        delay = self._due - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        self._due = max(self._due, time.monotonic() - self._interval) + self._interval
+
+        img = self._frames[self._next]
+        self._next = (self._next + 1) % len(self._frames)
+        return True, img.copy()  # a camera gives a new image each read
+
+    def release(self):
+        self._frames = []
+
+
+def open_camera(config=None):
+    """
+    Opens the configured camera or stand-in source and applies the capture settings.
+    Drivers silently ignore settings they do not support - use describe_camera to see what was applied.
+    :param config: the CameraConfig, None for the defaults
+    :return: the opened VideoCapture, or an ImageSource for an image file or directory
+    """
+    config = config or CameraConfig()
+
+    if isinstance(config.device, str):
+        if os.path.isdir(config.device) or config.device.lower().endswith(IMAGE_EXTENSIONS):
+            return ImageSource(config.device, config.source_fps)
+        return cv2.VideoCapture(config.device)  # a recorded video file
+
+    backend = platform_backend() if config.backend == "auto" else BACKENDS[config.backend]
+    cam = cv2.VideoCapture(config.device, backend)
+
+    # the format must be set before the resolution, some drivers only offer a resolution in one format
+    if config.fourcc is not None:
+        cam.set(cv2.CAP_PROP_FOURCC, cv2.VideoWriter_fourcc(*config.fourcc))
+    if config.width is not None:
+        cam.set(cv2.CAP_PROP_FRAME_WIDTH, config.width)
+    if config.height is not None:
+        cam.set(cv2.CAP_PROP_FRAME_HEIGHT, config.height)
+    if config.fps is not None:
+        cam.set(cv2.CAP_PROP_FPS, config.fps)
+    if config.buffer_size is not None:
+        cam.set(cv2.CAP_PROP_BUFFERSIZE, config.buffer_size)
+
+    if config.exposure is not None:
+        # manual exposure mode is 1 under V4L2 and 0.25 under DirectShow
+        cam.set(cv2.CAP_PROP_AUTO_EXPOSURE, 1 if backend == cv2.CAP_V4L2 else 0.25)
+        cam.set(cv2.CAP_PROP_EXPOSURE, config.exposure)
+    if config.white_balance is not None:
+        cam.set(cv2.CAP_PROP_AUTO_WB, 0)
+        cam.set(cv2.CAP_PROP_WB_TEMPERATURE, config.white_balance)
+
+    return cam
+
+
+def describe_camera(cam):
+    """
+    Reads back the settings the camera is actually using.
+    :param cam: an opened VideoCapture or ImageSource
+    :return: Dictionary of setting name to value
+    """
+    if isinstance(cam, ImageSource):
+        return {"source": "images", "opened": cam.isOpened()}
+    if not cam.isOpened():
+        return {"opened": False}
+
+    fourcc = int(cam.get(cv2.CAP_PROP_FOURCC))
+    return {
+        "backend": cam.getBackendName(),
+        "width": int(cam.get(cv2.CAP_PROP_FRAME_WIDTH)),
+        "height": int(cam.get(cv2.CAP_PROP_FRAME_HEIGHT)),
+        "fps": cam.get(cv2.CAP_PROP_FPS),
+        "fourcc": "".join(chr((fourcc >> (8 * i)) & 0xFF) for i in range(4)),
+        "exposure": cam.get(cv2.CAP_PROP_EXPOSURE),
+        "buffer_size": int(cam.get(cv2.CAP_PROP_BUFFERSIZE)),
+    }
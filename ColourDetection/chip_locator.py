@@ -0,0 +1,114 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the chip locator used to centre the ring scanning pattern on the chip.
+The chip edge is found with a Hough circle search on a downscaled grey image, and a narrow sampling band
+is placed on the chip's outer ring relative to it. The result is cached and refreshed periodically,
+so slot misalignment no longer needs a wide band around the image center.
+"""
+import threading
+import time
+
+import cv2
+
+import colour_detection as cd
+
+# the chip edge search - downscale factor for the Hough search, and the edge radius range in full size px
+LOCATE_SCALE = 0.25
+EDGE_RADIUS_RANGE = (160, 300)
+# the sampled band as fractions of the chip edge radius - inside the edge and outside the center label
+# the default 170-230 px band is 0.72-0.97 of the ~236 px chip edge in ImCap.jpg
+BAND = (0.78, 0.94)
+BAND_ANGLES = 180
+# seconds a located chip position is used before it is located again
+REFRESH_INTERVAL = 30.0
+# seconds before trying again when no chip has been located yet, e.g. the slot was empty
+RETRY_INTERVAL = 1.0
+
+
+def locate_chip(img, radius_range=EDGE_RADIUS_RANGE, scale=LOCATE_SCALE):
+    """
+    Finds the chip edge in a BGR image.
+    :param img: the BGR image
+    :param radius_range: (min, max) edge radius to search for, in px
+    :param scale: the factor the image is downscaled by for the search
+    :return: Tuple of (center x, center y, edge radius) in px, or None if no chip edge was found
+    """
+    grey = cv2.cvtColor(img, cv2.COLOR_BGR2GRAY)
+    small = cv2.medianBlur(cv2.resize(grey, None, fx=scale, fy=scale, interpolation=cv2.INTER_AREA), 5)
+
+    # only the strongest circle is wanted, so the minimum distance between circles is the whole image
+    circles = cv2.HoughCircles(small, cv2.HOUGH_GRADIENT, dp=1, minDist=max(small.shape), param1=100, param2=20,
+                               minRadius=int(radius_range[0] * scale), maxRadius=int(radius_range[1] * scale))
+    if circles is None:
+        return None
+
+    x, y, radius = circles[0][0] / scale
+    return float(x), float(y), float(radius)
+
+
+def centred_geometry(located, band=BAND, angles=BAND_ANGLES):
+    """
+    Places the sampling band on a located chip.
+    The center is rounded to whole px so small jitter between locates reuses the cached ring coordinates.
+    :param located: Tuple of (center x, center y, edge radius) from locate_chip
+    :param band: (inner, outer) band radius as fractions of the edge radius
+    :param angles: the number of angles sampled per radius
+    :return: the RingGeometry
+    """
+    x, y, radius = located
+    return cd.RingGeometry(inner=int(radius * band[0]), outer=int(radius * band[1]), angles=angles,
+                           center=(round(x), round(y)))
+
+
+class ChipLocator:
+    """
+    Caches the centred ring geometry, locating the chip again once the cached position is older than the refresh
+    interval. Until a chip has been located, the fallback geometry is used. Safe to share between threads.
+    """
+
+    def __init__(self, fallback=cd.DEFAULT_RING, refresh=REFRESH_INTERVAL):
+        """
+        :param fallback: the RingGeometry used until a chip is located
+        :param refresh: seconds before a located position is refreshed, None to locate only once
+        """
+        self.fallback = fallback
+        self.refresh = refresh
+        self._lock = threading.Lock()
+        self._geometry = None
+        self._located_at = None  # monotonic time of the last locate attempt, None before the first
+
+    def geometry(self, img):
+        """
+        Gets the ring geometry to sample img with, locating the chip in img if the cached position is stale.
+        A failed locate (e.g. an empty slot) keeps the last located position.
+        :param img: the BGR image about to be sampled
+        :return: the RingGeometry
+        """
+        with self._lock:
+            geometry, located_at = self._geometry, self._located_at
+        interval = RETRY_INTERVAL if geometry is None else self.refresh
+        if located_at is not None and (interval is None or time.monotonic() - located_at <= interval):
+            return geometry if geometry is not None else self.fallback
+
+        located = locate_chip(img)
+        if located is not None:
+            candidate = centred_geometry(located)
+            height, width = img.shape[:2]
+            try:
+                cd.ring_coordinates(height, width, candidate)  # a band off the image edge is not usable
+            except ValueError:
+                candidate = None
+            if candidate is not None:
+                geometry = candidate
+
+        with self._lock:
+            self._geometry, self._located_at = geometry, time.monotonic()
+        return geometry if geometry is not None else self.fallback
+
+    def reset(self):
+        """
+        Forgets the located position, so the next frame is located again.
+        """
+        with self._lock:
+            self._geometry, self._located_at = None, None
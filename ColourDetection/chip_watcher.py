@@ -0,0 +1,140 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the chip watcher used to analyse chips speculatively.
+Each captured frame is compared with the last on a coarse set of ring pixels; once the ring has changed
+and then held still for a few frames, a new chip has settled and is analysed straight away.
+The verdict is cached with its frame timestamp, so a later request is answered from the cache
+as long as the ring still matches the analysed frame and the colour tables have not been swapped since.
+"""
+import threading
+
+import numpy as np
+
+import colour_detection as cd
+
+# mean absolute difference (0-255 per channel) of the coarse ring pixels above which the ring has changed
+CHANGE_THRESHOLD = 12
+# consecutive unchanged frames before the chip is treated as settled and analysed
+SETTLE_FRAMES = 2
+
+
+def ring_signature(img, geometry=cd.DEFAULT_RING):
+    """
+    Samples the first (coarsest) progressive stage of the ring - a cheap fingerprint of the chip in the slot.
+    :param img: the BGR image to sample
+    :param geometry: the RingGeometry of the slot
+    :return: the sampled BGR values as a signed array, ready to difference
+    """
+    height, width = img.shape[:2]
+    pixels, offsets = cd.ring_stage_samples(height, width, geometry)[0]
+    return img.reshape(-1, 3).take(pixels, axis=0).astype(np.int16)
+
+
+def signature_difference(signature, reference):
+    """
+    :return: the mean absolute difference between two ring signatures
+    """
+    return float(np.abs(signature - reference).mean())
+
+
+class ChipWatcher:
+    """
+    Watches the capture stream for a new chip settling in the slot and analyses it ahead of any request.
+    """
+
+    def __init__(self, grabber, analyse, geometry=cd.DEFAULT_RING, change_threshold=CHANGE_THRESHOLD,
+                 settle_frames=SETTLE_FRAMES):
+        """
+        :param grabber: the started FrameGrabber to watch
+        :param analyse: callable taking (image, timestamp) and returning the verdict to cache
+        :param geometry: the RingGeometry of the slot
+        :param change_threshold: the signature_difference at which the ring counts as changed
+        :param settle_frames: consecutive unchanged frames before analysing
+        """
+        self._grabber = grabber
+        self._analyse = analyse
+        self.geometry = geometry
+        self.change_threshold = change_threshold
+        self.settle_frames = settle_frames
+
+        self._lock = threading.Lock()
+        self._verdict = None    # cached verdict, None when the ring has changed since it was analysed
+        self._timestamp = 0.0   # capture time of the analysed frame
+        self._reference = None  # ring signature of the analysed frame
+        self._tables = None     # colour tables installed when the frame was analysed
+        self._running = False
+        self._thread = None
+        self.analyses = 0       # speculative analyses run
+        self.hits = 0           # requests answered from the cache
+        self.misses = 0
+
+    def start(self):
+        """
+        Starts the watcher thread.
+        :return: this watcher, so it can be started where it is created
+        """
+        self._running = True
+        self._thread = threading.Thread(target=self._watch, name="ChipWatcher", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        """
+        Stops the watcher thread once its current frame is handled.
+        """
+        self._running = False
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+
+    def cached(self):
+        """
+        Gets the cached verdict if the latest frame still matches the analysed one.
+        Only the coarse ring pixels of the latest frame are compared, so a hit costs microseconds.
+        :return: Tuple of (verdict, analysed frame timestamp), or None if there is no current verdict
+        """
+        with self._lock:
+            verdict, timestamp, reference, tables = self._verdict, self._timestamp, self._reference, self._tables
+
+        img, latest = self._grabber.latest()
+        if verdict is None or img is None or tables is not cd.TABLES or \
+                signature_difference(ring_signature(img, self.geometry), reference) > self.change_threshold:
+            self.misses += 1
+            return None
+
+        self.hits += 1
+        return verdict, timestamp
+
+    def _watch(self):
+        """
+        Watcher thread - differences each new frame against the previous one and analyses once a change settles.
+        """
+        timestamp = 0.0
+        previous = None
+        still = 0
+        while self._running:
+            img, frame_timestamp = self._grabber.wait_for_frame(timestamp, 0.5)
+            if img is None:
+                continue  # no new frame, check for stop
+            timestamp = frame_timestamp
+
+            signature = ring_signature(img, self.geometry)
+            if previous is not None and signature_difference(signature, previous) > self.change_threshold:
+                # the ring is changing - a chip is arriving or leaving, so the cached verdict is stale
+                still = 0
+                with self._lock:
+                    self._verdict = None
+            else:
+                still += 1
+            previous = signature
+
+            # analyse once per settle, as soon as the ring has held still,
+            # and again if new colour tables have been installed since
+            if still >= self.settle_frames and (self._verdict is None or self._tables is not cd.TABLES):
+                tables = cd.TABLES
+                verdict = self._analyse(img, timestamp)
+                self.analyses += 1
+                with self._lock:
+                    self._verdict, self._timestamp, self._reference = verdict, timestamp, signature
+                    self._tables = tables
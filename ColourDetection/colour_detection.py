@@ -4,10 +4,24 @@ Creation Date: Feb. 13, 2023
 This module contains the image processing and colour detection code required to process
 poker chips and determine their colour.
 """
+import json
 import time
+from collections import namedtuple
+from contextlib import nullcontext
+from functools import lru_cache
 
 import cv2
 import math
+import numpy as np
+
+import camera
+
+# optional native ring kernel, built in place with: python setup.py build_ext --inplace
+# without it, the NumPy implementation below gives the same results
+try:
+    import ring_kernel
+except ImportError:
+    ring_kernel = None
 
 # manually define the hue colour ranges as a dictionary
 # keyed by colour name, valued by low/high range tuple
@@ -45,28 +59,303 @@ colour_ranges = {
 }
 
 
-def get_cam(cam_num=0):
+# saturation above this is colourful (categorized by hue), otherwise dull (categorized by value)
+SATURATION_THRESHOLD = 255 // 2
+# value above this is a white dull pixel, otherwise black
+VALUE_THRESHOLD = 255 // 2
+
+# ring scanning pattern geometry
+# inner/outer: radius range in px, inner inclusive and outer exclusive
+# angles: the number of evenly spaced angles sampled per radius
+# center: (x, y) of the ring in px, None for the center of the image
+RingGeometry = namedtuple("RingGeometry", ["inner", "outer", "angles", "center"], defaults=[170, 230, 360, None])
+# hypotenuse will range from 170px to 230px - determined from manual analysis of image capture to find hyp range
+DEFAULT_RING = RingGeometry()
+
+# progressive sampling - the ring samples are split into coarse to fine stages on the grid of radii and angles
+# each stage halves the grid stride, so together the stages cover every ring sample exactly once
+PROGRESSIVE_STRIDES = (8, 4, 2, 1)
+# stop sampling once the top two categories differ by this share of the pixels sampled so far
+PROGRESSIVE_MARGIN = 0.25
+
+# decision stage - a verdict with a category_margin below this is low confidence, so more frames are pulled and voted on
+DECISION_MARGIN = 0.2
+# seconds from the request that voting may take before the best verdict so far is returned
+VOTE_BUDGET = 0.15
+
+# a decided verdict: the colour, its category_margin, the number of frames voted on,
+# and the share of samples per category pooled over those frames
+Decision = namedtuple("Decision", ["colour", "margin", "frames", "shares"])
+
+# every category the board knows (ChipColour_Category in lib/ChipColour.h), in its order - a colour table config
+# may only report these, so the histogram reply can always carry every category's share
+BOARD_CATEGORIES = ("white", "black", "red", "orange", "yellow", "green", "blue", "purple", "pink")
+
+# everything the classifiers read, compiled from one set of colour ranges and thresholds
+# categories: the category names in reported order, white_index/black_index: the dull categories' indexes,
+# hue_lut: hue to category index (see build_hue_lut), hue_lut_bytes: the same table as bytes, for the native kernel
+ColourTables = namedtuple("ColourTables", ["ranges", "saturation_threshold", "value_threshold", "categories",
+                                           "white_index", "black_index", "hue_lut", "hue_lut_bytes"])
+
+
+def build_categories(ranges):
+    """
+    Lists the result categories in the order they are reported: white, black, then the colour ranges
+    in order, with the low and high red ranges concatenated into just red.
+    :param ranges: the hue colour ranges, keyed by colour name
+    :return: list of category names
+    """
+    categories = ["white", "black"]
+    for range_key in ranges:
+        # concat low and high red ranges into just red
+        name = "red" if "red" in range_key else range_key
+        if name not in categories:
+            categories.append(name)
+    return categories
+
+
+def build_hue_lut(ranges, categories):
+    """
+    Builds a lookup table from hue to category index, so a colourful pixel is categorized with a single index.
+    OpenCV hues stop at 179; the rest of the table lets any byte be looked up safely.
+    Hues outside every range map to len(categories), a bin that is not reported.
+    :param ranges: the hue colour ranges, keyed by colour name, low/high inclusive
+    :param categories: the category names, as returned by build_categories
+    :return: 256 entry array of category indexes
+    """
+    lut = np.full(256, len(categories), dtype=np.intp)
+    # fill in reverse so the first matching range wins, as in a front to back search
+    for range_key, (low, high) in reversed(list(ranges.items())):
+        name = "red" if "red" in range_key else range_key
+        lut[low:high + 1] = categories.index(name)
+    lut.flags.writeable = False
+    return lut
+
+
+def is_whole(value):
+    """
+    :return: True if value is a plain int - JSON true/false load as bool, which is also an int
+    """
+    return isinstance(value, int) and not isinstance(value, bool)
+
+
+def compile_tables(ranges, saturation_threshold=SATURATION_THRESHOLD, value_threshold=VALUE_THRESHOLD):
+    """
+    Checks a set of colour ranges and thresholds and compiles them into the classification tables.
+    :param ranges: the hue colour ranges, keyed by colour name, low/high inclusive OpenCV hues (0-179),
+    searched in order - names containing red are reported together as red, other names must be BOARD_CATEGORIES
+    :param saturation_threshold: saturation above this is colourful, otherwise dull (0-255)
+    :param value_threshold: value above this is a white dull pixel, otherwise black (0-255)
+    :return: the ColourTables
+    """
+    if not isinstance(ranges, dict):
+        raise ValueError(f"colour ranges must map colour names to [low, high], got {ranges!r}")
+
+    checked = {}
+    for range_key, bounds in ranges.items():
+        if range_key in ("white", "black"):
+            raise ValueError(f"colour range {range_key} is reserved for dull pixels")
+        if not (isinstance(bounds, (list, tuple)) and len(bounds) == 2 and
+                all(is_whole(bound) for bound in bounds) and 0 <= bounds[0] <= bounds[1] <= 179):
+            raise ValueError(f"colour range {range_key} must be whole hues with 0 <= low <= high <= 179, got {bounds}")
+        checked[range_key] = tuple(bounds)
+
+    for name, threshold in (("saturation", saturation_threshold), ("value", value_threshold)):
+        if not (is_whole(threshold) and 0 <= threshold <= 255):
+            raise ValueError(f"{name} threshold must be a whole number from 0 to 255, got {threshold}")
+
+    categories = tuple(build_categories(checked))
+    unknown = [name for name in categories if name not in BOARD_CATEGORIES]
+    if unknown:
+        raise ValueError(f"colour ranges {', '.join(unknown)} are not categories the board knows "
+                         f"({', '.join(BOARD_CATEGORIES)})")
+    lut = build_hue_lut(checked, categories)
+    return ColourTables(checked, saturation_threshold, value_threshold, categories, categories.index("white"),
+                        categories.index("black"), lut, lut.astype(np.uint8).tobytes())
+
+
+def load_tables(path):
+    """
+    Reads and compiles a colour table config - a JSON object with "colour_ranges" (name to [low, high], in order)
+    and optionally "saturation_threshold" and "value_threshold". See colour_tables.example.json.
+    :param path: the JSON config file
+    :return: the ColourTables
+    """
+    with open(path) as file:
+        config = json.load(file)
+    if not isinstance(config, dict):
+        raise ValueError(f"{path} must hold a JSON object")
+    if not config.get("colour_ranges"):
+        raise ValueError(f"{path} has no colour_ranges")
+    return compile_tables(config["colour_ranges"], config.get("saturation_threshold", SATURATION_THRESHOLD),
+                          config.get("value_threshold", VALUE_THRESHOLD))
+
+
+def install_tables(tables):
+    """
+    Swaps in new classification tables while the service is running.
+    The classifiers read TABLES once per call and use that one reference throughout, so every result
+    comes entirely from the old or the new tables; the swap itself is a single assignment.
+    :param tables: the ColourTables to classify with from now on
+    """
+    global TABLES, CATEGORIES, WHITE_INDEX, BLACK_INDEX, HUE_LUT, HUE_LUT_BYTES
+    TABLES = tables
+    # the current tables' fields under their own names, for callers that only report categories
+    CATEGORIES, WHITE_INDEX, BLACK_INDEX = tables.categories, tables.white_index, tables.black_index
+    HUE_LUT, HUE_LUT_BYTES = tables.hue_lut, tables.hue_lut_bytes
+
+
+TABLES = None
+install_tables(compile_tables(colour_ranges))
+
+
+@lru_cache(maxsize=16)
+def ring_coordinates(height, width, geometry=DEFAULT_RING):
+    """
+    Computes the pixel coordinates of the ring scanning pattern for an image of the given size.
+    The coordinates only depend on the image size and ring geometry, so they are computed once and cached.
+    :param height: the image height in pixels
+    :param width: the image width in pixels
+    :param geometry: the RingGeometry to sample
+    :return: Tuple of (y indexes, x indexes) arrays, one entry per sampled pixel
+    """
+    center_x, center_y = geometry.center if geometry.center is not None else (width / 2, height / 2)
+
+    # analyse the image in a ring pattern
+    # the pixels will be analysed in a full 360 degree ring
+    # the pixel will be hyp distance from the center of the ring
+    ys, xs = [], []
+    for hyp in range(geometry.inner, geometry.outer):
+        for angle_index in range(geometry.angles):
+            angle_deg = angle_index * 360 / geometry.angles
+            angle_rad = angle_deg * math.pi / 180  # convert angle to radians
+
+            # get the offset x and y positions relative to the center of the ring
+            off_x, off_y = hyp * math.cos(angle_rad), hyp * math.sin(angle_rad)
+
+            # get the absolute x and y positions of the pixel to analyse
+            ys.append(int(center_y + off_y))
+            xs.append(int(center_x + off_x))
+
+    ys, xs = np.array(ys, dtype=np.intp), np.array(xs, dtype=np.intp)
+    if ys.min() < 0 or xs.min() < 0 or ys.max() >= height or xs.max() >= width:
+        raise ValueError(f"ring {geometry} does not fit in a {width}x{height} image")
+
+    # the arrays are shared by every caller through the cache, so they must not be modified
+    ys.flags.writeable = False
+    xs.flags.writeable = False
+    return ys, xs
+
+
+@lru_cache(maxsize=16)
+def ring_roi(height, width, geometry=DEFAULT_RING):
+    """
+    Computes the bounding box of the ring scanning pattern and the ring coordinates relative to it,
+    so only that region of interest needs to be converted to HSV.
+    The coordinates are kept per sample rather than as a mask because the ring samples some pixels more than once.
+    :param height: the image height in pixels
+    :param width: the image width in pixels
+    :param geometry: the RingGeometry to sample
+    :return: Tuple of (y slice, x slice, y indexes, x indexes), the indexes relative to the region of interest
+    """
+    ys, xs = ring_coordinates(height, width, geometry)
+    y0, x0 = int(ys.min()), int(xs.min())
+
+    roi_ys, roi_xs = ys - y0, xs - x0
+    roi_ys.flags.writeable = False
+    roi_xs.flags.writeable = False
+    return slice(y0, int(ys.max()) + 1), slice(x0, int(xs.max()) + 1), roi_ys, roi_xs
+
+
+@lru_cache(maxsize=16)
+def ring_offsets(height, width, geometry=DEFAULT_RING):
+    """
+    Computes the byte offset of every ring pixel in a contiguous BGR image of the given size, for the native kernel.
+    :param height: the image height in pixels
+    :param width: the image width in pixels
+    :param geometry: the RingGeometry to sample
+    :return: int64 array of byte offsets, one entry per sampled pixel, in ring_coordinates order
+    """
+    ys, xs = ring_coordinates(height, width, geometry)
+    offsets = (ys.astype(np.int64) * width + xs) * 3
+    offsets.flags.writeable = False
+    return offsets
+
+
+def build_ring_stages(radius_count, angle_count, strides):
+    """
+    Splits the ring samples into progressive stages, coarse to fine.
+    Each stage holds the samples on a grid of every stride-th radius and angle not taken by an earlier stage.
+    :param radius_count: the number of radii in the ring pattern
+    :param angle_count: the number of angles per radius
+    :param strides: the grid stride of each stage, ending with 1 so every sample is covered
+    :return: list of sample index arrays (into the ring_coordinates order), one per stage
+    """
+    radius_index, angle_index = np.divmod(np.arange(radius_count * angle_count), angle_count)
+    taken = np.zeros(radius_count * angle_count, dtype=bool)
+    stages = []
+    for stride in strides:
+        on_grid = (radius_index % stride == 0) & (angle_index % stride == 0) & ~taken
+        stages.append(np.flatnonzero(on_grid))
+        taken |= on_grid
+    return stages
+
+
+@lru_cache(maxsize=16)
+def ring_stage_samples(height, width, geometry=DEFAULT_RING):
+    """
+    Computes the ring samples of each progressive stage for an image of the given size.
+    :param height: the image height in pixels
+    :param width: the image width in pixels
+    :param geometry: the RingGeometry to sample
+    :return: list of (pixel indexes, native kernel byte offsets) tuples, one per stage
+    """
+    offsets = ring_offsets(height, width, geometry)
+    stages = build_ring_stages(geometry.outer - geometry.inner, geometry.angles, PROGRESSIVE_STRIDES)
+    return [(offsets[stage] // 3, offsets[stage]) for stage in stages]
+
+
+@lru_cache(maxsize=16)
+def ring_batch(height, width, geometries):
+    """
+    Concatenates the ring samples of several rings in one image, so they can be gathered and converted together.
+    :param height: the image height in pixels
+    :param width: the image width in pixels
+    :param geometries: tuple of RingGeometry, one per ring
+    :return: Tuple of (pixel indexes, ring index of each sample)
+    """
+    offsets = [ring_offsets(height, width, geometry) for geometry in geometries]
+    pixels = np.concatenate(offsets) // 3
+    rings = np.repeat(np.arange(len(geometries)), [len(ring_offsets) for ring_offsets in offsets])
+    pixels.flags.writeable = False
+    rings.flags.writeable = False
+    return pixels, rings
+
+
+def get_cam(cam_num=0, config=None):
     """
     Gets an OpenCV VideoCapture to use for image capture and processing
     :param cam_num: selects which camera to get, if there are multiple cameras to use.
     If there is only 1 camera, cam0 is needed, so 0 is the default
+    :param config: the camera.CameraConfig to open with instead, for the backend, resolution, format,
+    exposure and buffer size, or a stand-in image source
     :return: VideoCapture camera
     """
-    # get the camera, reduce the buffer size to 1
-    return cv2.VideoCapture(cam_num, cv2.CAP_DSHOW)
+    # get the camera with the platform's capture backend, reduce the buffer size to 1
+    return camera.open_camera(config or camera.CameraConfig(device=cam_num))
 
 
-def manual_get_img(cam) -> 'image':
+def manual_get_img(grabber) -> 'image':
     """
     Uses OpenCV to display a camera feed.
-    When the user presses any key on the image window, the camera is released and the image is saved and returned.
-    :param cam: the camera to read from
+    When the user presses space on the image window, the image is saved and returned.
+    :param grabber: the started FrameGrabber to take frames from, it keeps the camera buffer drained
     :return: image from camera
     """
+    timestamp = 0.0
     while True:
-        # read and show the image from the camera
-        result, img = cam.read()
-        result, img = cam.read()
+        # wait for and show the next frame from the camera, each frame is shown once
+        img, timestamp = grabber.wait_for_frame(timestamp)
 
         # get the image dimensions (height and width)
         dim = img.shape  # returns: height, width, num channels
@@ -100,14 +389,13 @@ def manual_get_img(cam) -> 'image':
     # save the image as a file for review
     cv2.imwrite("ImCap.jpg", img)
 
-    cam.release()
-
     return img
 
 
 def get_img(cam):
     """
-    Accesses the passed camera, takes a picture, saves it, releases the camera, and returns the image for processing.
+    Accesses the passed camera, takes a picture, and returns the image for processing.
+    Images are not saved here - use a DebugRecorder to save analysed images for review.
     :param cam: the camera to read from
     :return: image from camera
     """
@@ -115,108 +403,200 @@ def get_img(cam):
     #cv2.imshow("ImCap", img)  # is crashing before it can load
     #cv2.waitKey(0)
     #cv2.destroyAllWindows()
-    cv2.imwrite("ImCap.jpg", img)  # save the image as a file for review
     return img  # return the image for processing
 
 
-def convert_and_scan(img):
+def convert_and_scan(img, geometry=DEFAULT_RING):
     """
-    Converts the passed image from BGR to HSV colour space.
+    Converts the ring region of the passed image from BGR to HSV colour space.
     After being converted, the HSV pixel values are scanned according a ring scanning pattern.
+    Only the bounding box of the ring is converted, the rest of the frame is never read.
     :param img: The image to convert to HSV and scan.
-    :return: The pixels to categorize and analyse.
+    :param geometry: the RingGeometry to sample
+    :return: The pixels to categorize and analyse, as an array with one HSV row per pixel.
     """
-    # convert the image from BGR format to HSV format
-    img_hsv = cv2.cvtColor(img, cv2.COLOR_BGR2HSV)
-
     # get the image dimensions
-    height, width, channels = img_hsv.shape  # returns: (height, width, num channels)
+    height, width = img.shape[:2]  # returns: (height, width, num channels)
 
-    # analyse the image in a ring pattern
-    # hypotenuse will range from 180px to 230px - determined from manual analysis of image capture to find hyp range
-    # the pixels will be analysed in a full 360 degree ring
-    # the pixel will be hyp distance from the center of the image
-    pixels = []
-    for hyp in range(170, 230):
-        for angle_deg in range(360):
-            angle_rad = angle_deg * math.pi / 180  # convert angle to radians
+    # convert only the region of interest around the ring from BGR format to HSV format
+    roi_y, roi_x, ys, xs = ring_roi(height, width, geometry)
+    roi_hsv = cv2.cvtColor(img[roi_y, roi_x], cv2.COLOR_BGR2HSV)
 
-            # get the offset x and y positions relative to the center of the image
-            off_x, off_y = hyp * math.cos(angle_rad), hyp * math.sin(angle_rad)
+    # gather the HSV values of every pixel in the ring at once - one (hue, saturation, value) row per pixel
+    return roi_hsv[ys, xs]  # openCv uses coordinate indexes as [y,x], not (x,y)
 
-            # get the absolute x and y positions of the pixel to analyse
-            pos_x, pos_y = int(width / 2 + off_x), int(height / 2 + off_y)
 
-            # get the HSV value of the target pixel - returns (hue, saturation, value)
-            pixels.append(img_hsv[pos_y, pos_x])  # openCv uses coordinate indexes as [y,x], not (x,y)
-    return pixels
+def pixel_categories(pixels, tables=None):
+    """
+    Categorizes each of the supplied HSV pixels, as categorize_pixels does.
+    :param pixels: The HSV pixels to categorize, any shape with (hue, saturation, value) as the last axis.
+    :param tables: the ColourTables to categorize with, None for the current TABLES
+    :return: Array of category indexes into the tables' categories, one per pixel,
+    len(categories) for hues outside the colour ranges
+    """
+    tables = TABLES if tables is None else tables
+    pixels = np.asarray(pixels, dtype=np.uint8).reshape(-1, 3)
+    hue, sat, val = pixels[:, 0], pixels[:, 1], pixels[:, 2]
+
+    # sat to determine colourful/dull, hue to determine colourful category, value to determine dull category
+    # may need to bias saturation check for distinguishing colour/dull based on lighting
+    # glare and reflections may bias the pixel value, so a bias in the value check can counteract the lighting bias
+    dull_category = np.where(val > tables.value_threshold, tables.white_index, tables.black_index)
+    return np.where(sat > tables.saturation_threshold, tables.hue_lut[hue], dull_category)
+
+
+def count_categories(pixels, tables=None):
+    """
+    Counts the supplied HSV pixels per category, as categorize_pixels does.
+    :param pixels: The HSV pixels to categorize, any shape with (hue, saturation, value) as the last axis.
+    :param tables: the ColourTables to categorize with, None for the current TABLES
+    :return: Array of pixel counts in the tables' category order, with an extra last bin for hues outside the
+    colour ranges
+    """
+    tables = TABLES if tables is None else tables
+    # count every category at once, the extra last bin holds any hue outside the colour ranges
+    return np.bincount(pixel_categories(pixels, tables), minlength=len(tables.categories) + 1)
 
 
-def categorize_pixels(pixels):
+def gather_hsv(img, pixels):
+    """
+    Gathers the pixels at the given indexes of a contiguous BGR image and converts only them to HSV.
+    :param img: The contiguous BGR image.
+    :param pixels: flat pixel indexes (y * width + x) to gather
+    :return: The HSV pixels, one (hue, saturation, value) row per index
+    """
+    bgr = img.reshape(-1, 3).take(pixels, axis=0)
+    # convert as a single row image - OpenCV converts row by row, so a column of single pixels is far slower
+    return cv2.cvtColor(bgr.reshape(1, -1, 3), cv2.COLOR_BGR2HSV).reshape(-1, 3)
+
+
+def categorize_pixels(pixels, tables=None):
     """
     Categorizes the supplied pixels into colourful and dull.
     Then, the colourful pixels are categorized by colour using the hue and defined colour ranges
     and the dull pixels are categorized using a biased analysis of the value component.
-    :param pixels: The HSV pixels to categorize.
-    :return: Tuple containing the categorized pixels, the number of colourful pixels, and the number of dull pixels
+    :param pixels: The HSV pixels to categorize, one (hue, saturation, value) row per pixel.
+    :param tables: the ColourTables to categorize with, None for the current TABLES
+    :return: Dictionary of pixel counts keyed by category, in the tables' category order
     """
-    # create the dictionary for the pixel values, keyed by colourful or dull
-    pixel_values = {"colourful": [], "dull": []}
+    tables = TABLES if tables is None else tables
+    counts = count_categories(pixels, tables)
+    return {name: int(counts[index]) for index, name in enumerate(tables.categories)}
 
-    # to store the results of categorizing the pixels
-    colour_cat = {"white": 0, "black": 0}
-    for range_key in colour_ranges:
-        # concat low and high red ranges into just red
-        if "red" in range_key:
-            colour_cat["red"] = 0
-        else:
-            colour_cat[range_key] = 0
-
-    for px in pixels:
-        # sat to determine colourful/dull, hue to determine colourful category, value to determine dull category
-        hue, sat, val = px
-
-        # may need to bias saturation check for distinguishing colour/dull based on lighting
-        if sat > 255//2:
-            # highly saturated pixels are colourful and can later be categorized by hue
-            for range_key, range_val in colour_ranges.items():
-                low, high = range_val
-                if low <= hue <= high:
-                    # concat low and high red ranges into just red
-                    if "red" in range_key:
-                        colour_cat["red"] += 1
-                    else:
-                        colour_cat[range_key] += 1
-                    continue  # stop processing the pixel when its range is found
-        else:
-            # lowly saturated pixels are dull and can be later categorized by value
-            # may need to toward black depending on room lighting
-            # glare and reflections may bias the pixel value, so a bias in this step can counteract the lighting bias
-            if val > 255//2:
-                colour_cat["white"] += 1
-            else:
-                colour_cat["black"] += 1
-
-    # find what range the colourful pixels fall into and add it to cat_pixels
-    for px_hue in pixel_values["colourful"]:
-        for range_key, range_val in colour_ranges.items():
-            low, high = range_val
-            if low <= px_hue <= high:
-                # concat low and high red ranges into just red
-                if "red" in range_key:
-                    colour_cat["red"] += 1
-                else:
-                    colour_cat[range_key] += 1
-                continue  # stop processing the pixel when its range is found
-
-    for px_val in pixel_values["dull"]:
-        # may need to toward black depending on room lighting because glare and reflections may bias the pixel value,
-        # so a bias in this step can reverse the bias due to lighting
-        if px_val > 255//2:
-            colour_cat["white"] += 1
+
+def traced(trace, span):
+    """
+    :param trace: the metrics Trace to time into, or None
+    :param span: the span name
+    :return: a context timing the enclosed block into the trace's span, or doing nothing without a trace
+    """
+    return nullcontext() if trace is None else trace.span(span)
+
+
+def kernel_counts(img, offsets, tables):
+    """
+    Counts the pixels at the given byte offsets of a contiguous BGR image per category with the native kernel.
+    :return: list of pixel counts in the tables' category order, with an extra last bin for hues outside the ranges
+    """
+    return ring_kernel.classify(img, offsets, tables.hue_lut_bytes, tables.saturation_threshold,
+                                tables.value_threshold, tables.white_index, tables.black_index,
+                                len(tables.categories) + 1)
+
+
+def classify_ring(img, geometry=DEFAULT_RING, tables=None, trace=None):
+    """
+    Scans and categorizes the ring of the passed BGR image - the same result as categorize_pixels(convert_and_scan(img)).
+    When the native kernel is built, only the ring pixels are converted to HSV and counted in one call.
+    :param img: The BGR image to analyse.
+    :param geometry: the RingGeometry to sample
+    :param tables: the ColourTables to categorize with, None for the current TABLES
+    :param trace: the Trace to time the convert and categorize spans into, or None
+    :return: Dictionary of pixel counts keyed by category, in the tables' category order
+    """
+    tables = TABLES if tables is None else tables
+    if ring_kernel is None:
+        with traced(trace, "convert"):
+            pixels = convert_and_scan(img, geometry)
+        with traced(trace, "categorize"):
+            return categorize_pixels(pixels, tables)
+
+    img = np.ascontiguousarray(img)
+    height, width = img.shape[:2]
+    offsets = ring_offsets(height, width, geometry)
+    # the kernel converts as it counts, so its whole call is categorizing
+    with traced(trace, "categorize"):
+        counts = kernel_counts(img, offsets, tables)
+    return {name: counts[index] for index, name in enumerate(tables.categories)}
+
+
+def classify_ring_progressive(img, min_margin=PROGRESSIVE_MARGIN, geometry=DEFAULT_RING, tables=None, trace=None):
+    """
+    Scans and categorizes the ring of the passed BGR image progressively, coarse to fine.
+    After each stage, sampling stops if the top two categories are at least min_margin apart,
+    so a clear chip is decided from a small fraction of the ring.
+    If every stage is needed, the result is the same as classify_ring(img).
+    :param img: The BGR image to analyse.
+    :param min_margin: the category_margin needed to stop early, above 1 always samples the whole ring
+    :param geometry: the RingGeometry to sample
+    :param tables: the ColourTables to categorize with, None for the current TABLES
+    :param trace: the Trace to time the convert and categorize spans into, or None
+    :return: Dictionary of pixel counts over the samples taken, keyed by category, in the tables' category order
+    """
+    # every stage uses the same tables, even if new ones are installed part way through
+    tables = TABLES if tables is None else tables
+    img = np.ascontiguousarray(img)
+    height, width = img.shape[:2]
+
+    counts = np.zeros(len(tables.categories) + 1, dtype=np.int64)
+    for pixels, offsets in ring_stage_samples(height, width, geometry):
+        if ring_kernel is None:
+            # gather and convert only this stage's pixels
+            with traced(trace, "convert"):
+                hsv = gather_hsv(img, pixels)
+            with traced(trace, "categorize"):
+                counts += count_categories(hsv, tables)
         else:
-            colour_cat["black"] += 1
-    return colour_cat
+            with traced(trace, "categorize"):
+                counts += kernel_counts(img, offsets, tables)
+
+        categories = {name: int(counts[index]) for index, name in enumerate(tables.categories)}
+        if category_margin(categories) >= min_margin:
+            break
+
+    return categories
+
+
+def classify_rings(img, geometries, tables=None, trace=None):
+    """
+    Scans and categorizes several rings in one BGR image, e.g. every slot of a staging tray in view.
+    Each result is the same as classify_ring(img, geometry) for that ring.
+    With the native kernel each ring is one kernel call; otherwise the samples of every ring are gathered,
+    converted and counted in one vectorised pass.
+    :param img: The BGR image to analyse.
+    :param geometries: sequence of RingGeometry, one per ring
+    :param tables: the ColourTables to categorize with, None for the current TABLES
+    :param trace: the Trace to time the convert and categorize spans into, or None
+    :return: list of dictionaries of pixel counts keyed by category, in geometries order
+    """
+    tables = TABLES if tables is None else tables
+    geometries = tuple(geometries)
+    if ring_kernel is not None:
+        return [classify_ring(img, geometry, tables, trace) for geometry in geometries]
+
+    img = np.ascontiguousarray(img)
+    height, width = img.shape[:2]
+    pixels, rings = ring_batch(height, width, geometries)
+
+    # gather and convert every ring's pixels at once
+    with traced(trace, "convert"):
+        hsv = gather_hsv(img, pixels)
+
+    # count per ring and category at once by giving each ring its own block of bins
+    with traced(trace, "categorize"):
+        categories = pixel_categories(hsv, tables)
+        bins = len(tables.categories) + 1
+        counts = np.bincount(rings * bins + categories, minlength=len(geometries) * bins).reshape(-1, bins)
+    return [{name: int(ring_counts[index]) for index, name in enumerate(tables.categories)} for ring_counts in counts]
 
 
 def analyse_categories(categorized_results):
@@ -224,3 +604,68 @@ def analyse_categories(categorized_results):
     for colour, count in categorized_results.items():
         if count == max_count:
             return colour
+
+
+def category_margin(categorized_results):
+    """
+    Gives how clearly the top category wins, as the difference between the top two counts
+    over the total count.
+    :param categorized_results: Dictionary of pixel counts keyed by category
+    :return: margin from 0 (tied) to 1 (every pixel in one category)
+    """
+    total = sum(categorized_results.values())
+    if not total:
+        return 0.0
+    top, second = sorted(categorized_results.values(), reverse=True)[:2]
+    return (top - second) / total
+
+
+def decide(categorized_results, frames=1):
+    """
+    Decides the verdict for categorized results, reporting how clear it is.
+    :param categorized_results: Dictionary of pixel counts (or shares) keyed by category
+    :param frames: the number of frames the results were pooled from
+    :return: Decision with the top category, its category_margin, and the share of samples per category
+    """
+    total = sum(categorized_results.values())
+    shares = {name: count / total if total else 0.0 for name, count in categorized_results.items()}
+    return Decision(analyse_categories(categorized_results), category_margin(categorized_results), frames, shares)
+
+
+def decide_with_voting(grabber, img, timestamp, classify=classify_ring_progressive, min_margin=DECISION_MARGIN,
+                       budget=VOTE_BUDGET, trace=None):
+    """
+    Decides the verdict for a frame, voting over further frames when it is not clear.
+    A frame with a margin of at least min_margin is decided on its own, keeping the common case fast.
+    Otherwise new frames are pulled from the grabber and their sample shares pooled, each frame weighted equally,
+    until the pooled margin reaches min_margin or the time budget runs out, so a single glare-affected
+    frame cannot decide a close call.
+    :param grabber: the FrameGrabber to pull further frames from
+    :param img: the first BGR frame to analyse
+    :param timestamp: the monotonic capture timestamp of the first frame
+    :param classify: the ring classifier to apply to each frame
+    :param min_margin: the category_margin needed to stop voting
+    :param budget: seconds from the call that voting may take
+    :param trace: the Trace to time the waits for further frames into, as its capture span, or None
+    :return: Decision over the frames voted on
+    """
+    deadline = time.monotonic() + budget
+    decision = decide(classify(img))
+    pooled = dict(decision.shares)
+
+    while decision.margin < min_margin:
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            break
+
+        with traced(trace, "capture"):
+            img, timestamp = grabber.wait_for_frame(timestamp, remaining)
+        if img is None:
+            break
+
+        # by name, so a frame classified with newly installed tables still pools
+        for name, share in decide(classify(img)).shares.items():
+            pooled[name] = pooled.get(name, 0.0) + share
+        decision = decide(pooled, decision.frames + 1)
+
+    return decision
@@ -0,0 +1,110 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the debug recorder used to save analysed frames for review.
+Frames are JPEG-encoded and written on a background thread, fed through a bounded queue,
+so a slow disk drops debug images instead of stalling analysis.
+"""
+import os
+import queue
+import threading
+import time
+
+import cv2
+
+# recording modes
+RECORD_ALL = "all"                          # every analysed frame
+RECORD_SAMPLED = "sampled"                  # one analysed frame in every N
+RECORD_LOW_CONFIDENCE = "low_confidence"    # only frames whose verdict confidence is below the threshold
+
+
+class DebugRecorder:
+    """
+    Saves selected analysed frames with their verdict in the filename, on a background thread.
+    """
+
+    def __init__(self, directory, mode=RECORD_ALL, every=10, threshold=0.5, queue_size=8):
+        """
+        :param directory: the directory to write images to, created if it does not exist
+        :param mode: RECORD_ALL, RECORD_SAMPLED or RECORD_LOW_CONFIDENCE
+        :param every: for RECORD_SAMPLED, record one frame in this many
+        :param threshold: for RECORD_LOW_CONFIDENCE, record frames with a confidence below this (0-1)
+        :param queue_size: frames waiting to be written before new ones are dropped
+        """
+        if mode not in (RECORD_ALL, RECORD_SAMPLED, RECORD_LOW_CONFIDENCE):
+            raise ValueError(f"unknown recording mode {mode}")
+
+        self.directory = directory
+        self.mode = mode
+        self.every = max(1, every)
+        self.threshold = threshold
+        self.dropped = 0    # frames that were selected but did not fit in the queue
+        self.written = 0
+
+        self._queue = queue.Queue(maxsize=queue_size)
+        self._offered = 0
+        self._thread = None
+        os.makedirs(directory, exist_ok=True)
+
+    def start(self):
+        """
+        Starts the writer thread.
+        :return: this recorder, so it can be started where it is created
+        """
+        self._thread = threading.Thread(target=self._write, name="DebugRecorder", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        """
+        Writes any queued frames and stops the writer thread.
+        """
+        if self._thread is not None:
+            self._queue.put(None)  # blocking, the stop marker must not be dropped
+            self._thread.join()
+            self._thread = None
+
+    def record(self, img, colour, confidence=1.0):
+        """
+        Offers an analysed frame to the recorder. Never blocks - if the queue is full, the frame is dropped.
+        A selected frame is copied when queued, so it may come from a reused buffer such as the shared frame ring.
+        :param img: the analysed BGR image
+        :param colour: the verdict, embedded in the filename
+        :param confidence: the verdict confidence (0-1), e.g. its margin, used by RECORD_LOW_CONFIDENCE
+        :return: True if the frame was queued to be written
+        """
+        self._offered += 1
+        if self.mode == RECORD_SAMPLED and self._offered % self.every != 0:
+            return False
+        if self.mode == RECORD_LOW_CONFIDENCE and confidence >= self.threshold:
+            return False
+
+        try:
+            if self._queue.full():
+                raise queue.Full  # don't pay for the copy of a frame that would be dropped
+            self._queue.put_nowait((img.copy(), colour, confidence, time.time(), self._offered))
+        except queue.Full:
+            self.dropped += 1
+            return False
+        return True
+
+    def __enter__(self):
+        return self.start()
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.stop()
+
+    def _write(self):
+        """
+        Writer thread - encodes and saves queued frames until the stop marker arrives.
+        """
+        while True:
+            item = self._queue.get()
+            if item is None:
+                return
+
+            img, colour, confidence, stamp, number = item
+            # e.g. 20261019-142501_000042_blue_87.jpg - capture time, frame number, verdict, confidence %
+            name = f"{time.strftime('%Y%m%d-%H%M%S', time.localtime(stamp))}_{number:06d}_{colour}_{int(confidence * 100)}.jpg"
+            cv2.imwrite(os.path.join(self.directory, name), img)
+            self.written += 1
@@ -0,0 +1,89 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the background frame grabber used by the vision service.
+A capture thread continuously drains the camera and keeps only the most recent frame,
+so a request can use a current image immediately instead of reading through a stale capture buffer.
+"""
+import threading
+import time
+
+
+class FrameGrabber:
+    """
+    Continuously reads frames from a camera on a background thread.
+    Only the most recent frame and the time it was read are kept, in a lock-protected slot.
+    Frames are shared with every caller, so they must be treated as read-only.
+    """
+
+    def __init__(self, cam):
+        """
+        :param cam: the OpenCV VideoCapture to drain, released when the grabber is stopped
+        """
+        self._cam = cam
+        self._slot = threading.Condition()
+        self._frame = None
+        self._timestamp = 0.0
+        self._running = False
+        self._thread = None
+
+    def start(self):
+        """
+        Starts the capture thread.
+        :return: this grabber, so it can be started where it is created
+        """
+        self._running = True
+        self._thread = threading.Thread(target=self._capture, name="FrameGrabber", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        """
+        Stops the capture thread and releases the camera.
+        """
+        self._running = False
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+        self._cam.release()
+
+    def latest(self):
+        """
+        Gets the most recent frame without waiting.
+        :return: Tuple of (frame, monotonic timestamp), frame is None if nothing has been captured yet
+        """
+        with self._slot:
+            return self._frame, self._timestamp
+
+    def wait_for_frame(self, newer_than=0.0, timeout=None):
+        """
+        Waits for a frame captured after the given time.
+        :param newer_than: monotonic timestamp the frame must be newer than, 0 takes any frame
+        :param timeout: seconds to wait, None waits forever
+        :return: Tuple of (frame, monotonic timestamp), frame is None on timeout
+        """
+        with self._slot:
+            if not self._slot.wait_for(lambda: self._frame is not None and self._timestamp > newer_than, timeout):
+                return None, 0.0
+            return self._frame, self._timestamp
+
+    def __enter__(self):
+        return self.start()
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.stop()
+
+    def _capture(self):
+        """
+        Capture thread - reads frames as fast as the camera delivers them, replacing the slot each time.
+        """
+        while self._running:
+            result, img = self._cam.read()  # blocks until the camera delivers the next frame
+            if not result:
+                time.sleep(0.01)  # camera not ready or unplugged, don't spin
+                continue
+
+            # read allocates a new image each call, so the previous frame is never modified under a reader
+            with self._slot:
+                self._frame, self._timestamp = img, time.monotonic()
+                self._slot.notify_all()
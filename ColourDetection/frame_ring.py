@@ -0,0 +1,253 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the shared-memory frame ring that lets several processes use one camera.
+The publisher owns the camera and writes each frame into the next slot of a ring in shared memory,
+stamped with a sequence number and capture time. Subscribers in other processes (the sorter service,
+a preview window, a recorder) read frames straight out of shared memory without copying or capturing again.
+Run the publisher with: python frame_ring.py [--name chip_frames] [--device 1] [--slots 8]
+"""
+import argparse
+import os
+import signal
+import time
+from multiprocessing import resource_tracker, shared_memory
+
+import numpy as np
+
+DEFAULT_NAME = "chip_frames"
+DEFAULT_SLOTS = 8
+
+# ring header, int64 fields: magic, slot count, height, width, channels, latest published sequence number
+HEADER_FIELDS = 6
+RING_MAGIC = 0x43484950  # "CHIP"
+# slot header, 8 bytes each: sequence number (int64, -1 while being written) and capture time (float64)
+SLOT_HEADER_BYTES = 16
+
+
+def attach(name):
+    """
+    Attaches to an existing shared memory block without taking ownership of it.
+    :param name: the shared memory name
+    :return: the SharedMemory
+    """
+    try:
+        return shared_memory.SharedMemory(name=name, track=False)  # Python 3.13+
+    except TypeError:
+        shm = shared_memory.SharedMemory(name=name)
+        # before 3.13 attaching registers the block with this process's resource tracker, which unlinks it
+        # when this process exits - pulling the ring out from under the publisher and every other subscriber
+        if os.name == "posix":
+            resource_tracker.unregister(shm._name, "shared_memory")
+        return shm
+
+
+class FrameRing:
+    """
+    The shared-memory layout: a header, then one (slot header, frame) pair per slot.
+    """
+
+    def __init__(self, shm, slots, shape):
+        self.shm = shm
+        self.slots = slots
+        self.shape = tuple(shape)
+        self.frame_bytes = int(np.prod(shape))
+        self.slot_bytes = SLOT_HEADER_BYTES + (self.frame_bytes + 7) // 8 * 8  # keep every slot 8-byte aligned
+
+        self.header = np.ndarray(HEADER_FIELDS, dtype=np.int64, buffer=shm.buf)
+        base = HEADER_FIELDS * 8
+        self.sequences = [np.ndarray(1, dtype=np.int64, buffer=shm.buf, offset=base + i * self.slot_bytes)
+                          for i in range(slots)]
+        self.timestamps = [np.ndarray(1, dtype=np.float64, buffer=shm.buf, offset=base + i * self.slot_bytes + 8)
+                           for i in range(slots)]
+        self.frames = [np.ndarray(self.shape, dtype=np.uint8, buffer=shm.buf,
+                                  offset=base + i * self.slot_bytes + SLOT_HEADER_BYTES) for i in range(slots)]
+
+    @staticmethod
+    def size(slots, shape):
+        """
+        :return: the shared memory bytes needed for a ring of the given slot count and frame shape
+        """
+        return HEADER_FIELDS * 8 + slots * (SLOT_HEADER_BYTES + (int(np.prod(shape)) + 7) // 8 * 8)
+
+    def close(self):
+        # the numpy views must go before the shared memory can be closed
+        self.header = self.sequences = self.timestamps = self.frames = None
+        self.shm.close()
+
+
+class FramePublisher:
+    """
+    Owns the shared-memory ring and publishes frames into it.
+    """
+
+    def __init__(self, shape, name=DEFAULT_NAME, slots=DEFAULT_SLOTS):
+        """
+        :param shape: the (height, width, channels) of every frame
+        :param name: the shared memory name subscribers attach to
+        :param slots: frames kept in the ring - a subscriber's frame stays valid for slots - 1 newer frames
+        """
+        shm = shared_memory.SharedMemory(name=name, create=True, size=FrameRing.size(slots, shape))
+        self._ring = FrameRing(shm, slots, shape)
+        for sequence in self._ring.sequences:
+            sequence[0] = -1
+        self._ring.header[:] = [RING_MAGIC, slots, *shape, -1]
+        self._sequence = -1
+
+    def publish(self, img, timestamp=None):
+        """
+        Copies a frame into the next slot and makes it the latest.
+        :param img: the frame, of the ring's shape
+        :param timestamp: the monotonic capture time, None for now
+        :return: the frame's sequence number
+        """
+        ring = self._ring
+        self._sequence += 1
+        slot = self._sequence % ring.slots
+
+        # mark the slot as being written, so a subscriber still reading its old frame can tell it was overwritten
+        ring.sequences[slot][0] = -1
+        ring.frames[slot][...] = img
+        ring.timestamps[slot][0] = time.monotonic() if timestamp is None else timestamp
+        ring.sequences[slot][0] = self._sequence
+        ring.header[5] = self._sequence
+        return self._sequence
+
+    def close(self):
+        shm = self._ring.shm
+        self._ring.close()
+        shm.unlink()
+
+
+class FrameSubscriber:
+    """
+    Reads frames from a publisher's ring in another process, with the FrameGrabber interface
+    so it can be used wherever a grabber is.
+    Frames are read-only views into shared memory, not copies; a view stays valid until slots - 1 newer frames
+    are published (about a quarter second for 8 slots at 30 fps). Anything holding a frame longer must copy it.
+    """
+
+    def __init__(self, name=DEFAULT_NAME, poll_interval=0.001):
+        """
+        :param name: the shared memory name of the publisher's ring
+        :param poll_interval: seconds between checks for a new frame while waiting
+        """
+        shm = attach(name)
+        header = np.ndarray(HEADER_FIELDS, dtype=np.int64, buffer=shm.buf)
+        if header[0] != RING_MAGIC:
+            shm.close()
+            raise ValueError(f"shared memory {name} is not a frame ring")
+        self._ring = FrameRing(shm, int(header[1]), header[2:5])
+        self._poll_interval = poll_interval
+        for frame in self._ring.frames:
+            frame.flags.writeable = False
+
+    def start(self):
+        """
+        Nothing to start - the publisher captures. Present so a subscriber can stand in for a FrameGrabber.
+        :return: this subscriber
+        """
+        return self
+
+    def stop(self):
+        """
+        Detaches from the ring. Frames read from it must not be used afterwards.
+        """
+        if self._ring is not None:
+            self._ring.close()
+            self._ring = None
+
+    def latest_sequence(self):
+        """
+        :return: the sequence number of the latest published frame, -1 if none yet
+        """
+        return int(self._ring.header[5])
+
+    def read(self, sequence):
+        """
+        Reads a published frame by sequence number.
+        :param sequence: the frame's sequence number
+        :return: Tuple of (frame view, monotonic timestamp), frame is None if the frame was overwritten or not published
+        """
+        ring = self._ring
+        slot = sequence % ring.slots
+        timestamp = float(ring.timestamps[slot][0])
+        # the slot sequence is checked after reading the timestamp, so a slot rewritten meanwhile is never returned
+        if sequence < 0 or ring.sequences[slot][0] != sequence:
+            return None, 0.0
+        return ring.frames[slot], timestamp
+
+    def is_valid(self, sequence):
+        """
+        :return: True while the frame with this sequence number has not been overwritten
+        """
+        return self._ring.sequences[sequence % self._ring.slots][0] == sequence
+
+    def latest(self):
+        """
+        Gets the most recent frame without waiting.
+        :return: Tuple of (frame view, monotonic timestamp), frame is None if nothing has been published yet
+        """
+        while True:
+            img, timestamp = self.read(self.latest_sequence())
+            if img is not None or self.latest_sequence() < 0:
+                return img, timestamp
+            # overwritten between reading the latest sequence and its slot - take the newer one
+
+    def wait_for_frame(self, newer_than=0.0, timeout=None):
+        """
+        Waits for a frame captured after the given time.
+        :param newer_than: monotonic timestamp the frame must be newer than, 0 takes any frame
+        :param timeout: seconds to wait, None waits forever
+        :return: Tuple of (frame view, monotonic timestamp), frame is None on timeout
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            img, timestamp = self.latest()
+            if img is not None and timestamp > newer_than:
+                return img, timestamp
+            if deadline is not None and time.monotonic() >= deadline:
+                return None, 0.0
+            time.sleep(self._poll_interval)
+
+    def __enter__(self):
+        return self.start()
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.stop()
+
+
+if __name__ == "__main__":
+    import sys
+
+    import camera
+
+    parser = argparse.ArgumentParser(description="Publish camera frames to a shared-memory ring.")
+    parser.add_argument("--name", default=DEFAULT_NAME, help="shared memory name subscribers attach to")
+    parser.add_argument("--device", default="1", help="camera index, or an image file/directory/video to stand in")
+    parser.add_argument("--slots", type=int, default=DEFAULT_SLOTS, help="frames kept in the ring")
+    args = parser.parse_args()
+
+    device = int(args.device) if args.device.isdigit() else args.device
+    cam = camera.open_camera(camera.CameraConfig(device=device))
+    result, img = cam.read()
+    if not result:
+        raise SystemExit(f"could not read from camera {args.device}")
+
+    # stop cleanly on a terminate as well as Ctrl+C, so the shared memory is always released
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(0))
+
+    publisher = FramePublisher(img.shape, args.name, args.slots)
+    print(f"Publishing {img.shape[1]}x{img.shape[0]} frames to {args.name}: {camera.describe_camera(cam)}")
+    try:
+        while True:
+            publisher.publish(img)
+            result, img = cam.read()  # blocks until the camera delivers the next frame
+            while not result:
+                time.sleep(0.01)  # camera not ready or unplugged, don't spin
+                result, img = cam.read()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        publisher.close()
+        cam.release()
@@ -4,60 +4,94 @@ Creation Date: Feb. 8, 2023
 Rev. History on GitHub
 This program will take a picture of a poker and analyse its outer ring.
 Its colour will then be determined using defined colour ranges and saturation values
+To serve several sorters from one process, use vision_host.py
 """
-import time
 import colour_detection as cd
 import serial
+from camera import CameraConfig, describe_camera
+from chip_locator import ChipLocator
+from debug_recorder import DebugRecorder, RECORD_ALL, RECORD_SAMPLED, RECORD_LOW_CONFIDENCE
+from frame_ring import FrameSubscriber
+from metrics import Metrics
+from sorter import Sorter
+from tables_watcher import TablesWatcher
+
+# analysed frames can be saved for review on a background thread, off the analysis path
+# None disables recording, otherwise RECORD_ALL, RECORD_SAMPLED (1 in DEBUG_RECORD_EVERY)
+# or RECORD_LOW_CONFIDENCE (verdict margin below DEBUG_RECORD_THRESHOLD)
+DEBUG_RECORD_MODE = None
+DEBUG_RECORD_DIR = "debug_images"
+DEBUG_RECORD_EVERY = 10
+DEBUG_RECORD_THRESHOLD = cd.DECISION_MARGIN
+
+# request timing traces can be appended to a file (.csv for CSV, otherwise JSON lines) and served as text
+# at http://127.0.0.1:<METRICS_PORT>/metrics - None disables either
+METRICS_EXPORT = None
+METRICS_PORT = None
+
+# the camera to capture from - set device to an image file or directory to run without a webcam
+CAMERA = CameraConfig(device=1)
+# to share the camera with a live preview (manual_test.py), run frame_ring.py to publish it
+# and set this to the ring's name - the service then reads frames from the ring instead of opening CAMERA
+SHARED_FRAMES = None
+SERIAL_PORT = "COM3"
+# True to locate the chip and sample a narrow band centred on it, instead of the fixed band around the image center
+LOCATE_CHIP = False
+# staging tray slots in view, answered together by a 't' request - a list of cd.RingGeometry, or None for no tray
+TRAY_SLOTS = None
+# colour ranges and thresholds to classify with (see colour_tables.example.json), reloaded whenever the file
+# changes so lighting can be retuned without a restart - None for the built-in colour_ranges
+COLOUR_TABLES = None
+
 
 if __name__ == "__main__":
     # connect to the serial port
-    ser = serial.Serial(port="COM3", baudrate=9600, timeout=1)
+    ser = serial.Serial(port=SERIAL_PORT, baudrate=9600, timeout=1)
+
+    tables_watcher = TablesWatcher(COLOUR_TABLES).start() if COLOUR_TABLES is not None else None
 
     # gets the camera to use for capture
-    cam = cd.get_cam(1)
-
-    # for this testing version, loop until the user manually stops the program
-    while True:
-        # gets the current image from the camera every loop so that if the image is processed, it is current
-        # and not old due to the buffer being populated
-        # https://stackoverflow.com/questions/43665208/how-to-get-the-latest-frame-from-capture-device-camera-in-opencv/63057626#63057626
-        # user: imtherf
-        img = cd.get_img(cam)
-
-        # if there is data waiting to be read, read 1 byte and check if it is an analysis request
-        if ser.in_waiting > 0:
-            ser_in = ser.read(1)  # read 1 byte
-            # print(f"ser_in : {ser_in}")  # debug line - displays the read data
-
-            # if the byte that was read is 'a' for analyse, process the image
-            if ser_in.decode() == 'a':
-                # print("Processing...")  # debug line
-
-                img_pixels = cd.convert_and_scan(img)
-
-                categories = cd.categorize_pixels(img_pixels)
-                print("Results:")
-                print(categories)
-
-                colour = cd.analyse_categories(categories)
-                print(f"The chip is {colour}")
-
-                # send a byte back through serial to indicate to the other device what colour the chip is
-                # r=Red, g=Green, b=Blue, w=White, k=Black, o=Other
-                # k is used for black because b is used for blue and simplifying to a single byte is simpler to process
-                match colour:
-                    case 'red':
-                        ser_out = 'r'
-                    case 'green':
-                        ser_out = 'g'
-                    case 'blue':
-                        ser_out = 'b'
-                    case 'white':
-                        ser_out = 'w'
-                    case 'black':
-                        ser_out = 'k'
-                    case other:
-                        ser_out = 'o'
-
-                # write the encoded colour byte to the other device using serial
-                ser.write(ser_out.encode())
+    # the sorter drains the camera on its own thread so the latest frame is always current
+    # and not old due to the buffer being populated
+    # https://stackoverflow.com/questions/43665208/how-to-get-the-latest-frame-from-capture-device-camera-in-opencv/63057626#63057626
+    # user: imtherf
+    if SHARED_FRAMES is not None:
+        cam = FrameSubscriber(SHARED_FRAMES)
+        print(f"Camera: frames shared through {SHARED_FRAMES}")
+    else:
+        cam = cd.get_cam(config=CAMERA)
+        print(f"Camera: {describe_camera(cam)}")
+
+    recorder = None
+    if DEBUG_RECORD_MODE is not None:
+        recorder = DebugRecorder(DEBUG_RECORD_DIR, DEBUG_RECORD_MODE, DEBUG_RECORD_EVERY,
+                                 DEBUG_RECORD_THRESHOLD).start()
+
+    metrics = Metrics(export_path=METRICS_EXPORT)
+    if METRICS_PORT is not None:
+        metrics.serve(METRICS_PORT)
+
+    # the sorter analyses each chip as soon as it settles in the slot, ahead of the request,
+    # and its serial thread answers as soon as an 'a' (analyse) or 'h' (histogram) byte arrives
+    sorter = Sorter("sorter", ser, cam, recorder=recorder, slots=TRAY_SLOTS, metrics=metrics,
+                    locator=ChipLocator() if LOCATE_CHIP else None).start()
+
+    # run until the user manually stops the program, or the serial thread ends (e.g. the port is lost)
+    ended = False
+    try:
+        while sorter.service.join(1):
+            pass
+        ended = True
+        print("Serial service ended - stopping the sorter")
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sorter.stop()
+        if tables_watcher is not None:
+            tables_watcher.stop()
+        metrics.close()
+        if recorder is not None:
+            recorder.stop()
+
+    if ended:
+        raise SystemExit(1)
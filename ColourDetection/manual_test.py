@@ -2,18 +2,28 @@
 Author: Andrew Belter:
 Creation Date: Feb. 13, 2023
 This file allows for manual triggering and testing of image processing.
+When frame_ring.py is publishing the camera, this previews the shared frames, so it can run alongside the sorter
+service; otherwise it opens the camera itself.
+Usage: python manual_test.py [ring name]
 """
+import sys
 
 import colour_detection as cd
+from frame_grabber import FrameGrabber
+from frame_ring import DEFAULT_NAME, FrameSubscriber
 
-while True:
-    cam = cd.get_cam(1)
-
-    img = cd.manual_get_img(cam)
+# preview the shared frame ring if it is being published, otherwise
+# the grabber keeps the camera open and drained between captures
+try:
+    grabber = FrameSubscriber(sys.argv[1] if len(sys.argv) > 1 else DEFAULT_NAME)
+except FileNotFoundError:
+    grabber = FrameGrabber(cd.get_cam(1)).start()
 
-    img_pixels = cd.convert_and_scan(img)
+while True:
+    # copy the picked frame, a shared ring frame is only valid until the publisher comes back round to its slot
+    img = cd.manual_get_img(grabber).copy()
 
-    categories = cd.categorize_pixels(img_pixels)
+    categories = cd.classify_ring(img)
     print("Results:")
     print(categories)
 
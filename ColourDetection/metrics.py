@@ -0,0 +1,188 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the request tracing and metrics used by the vision service.
+Each request gets a trace with an ID and timing spans; finished traces feed rolling percentiles per span,
+can be exported as JSON lines or CSV, and are served as text from a local-only HTTP endpoint.
+"""
+import csv
+import json
+import threading
+import time
+from collections import deque
+from contextlib import contextmanager
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+import numpy as np
+
+# request timing spans, in ms
+# frame_age: how old the analysed frame was when the request arrived
+# cache: checking the chip watcher's cached verdict
+# capture: taking the latest frame, and waiting for each further frame voted on
+# convert: gathering the ring samples and converting them to HSV, summed over every frame analysed
+# categorize: the hue lookup and per-category counting, summed over every frame analysed
+#             (the native kernel converts as it counts, so with it this includes convert)
+# classify: ring sampling, HSV conversion and categorizing, summed over every frame analysed
+# analyse: the whole analysis including voting and waiting for a pool worker
+# serial_write: writing the reply
+# total: request byte received to reply written
+SPANS = ("frame_age", "cache", "capture", "convert", "categorize", "classify", "analyse", "serial_write", "total")
+PERCENTILES = (50, 90, 99)
+
+
+class Trace:
+    """
+    The timing spans and outcome of one request.
+    """
+
+    def __init__(self, request_id, sorter, request):
+        self.request_id = request_id
+        self.sorter = sorter
+        self.request = request
+        self.time = time.time()
+        self.start = time.perf_counter()
+        self.spans = {}
+        self.verdict = None
+        self.cached = False
+        self.frames = 0
+
+    @contextmanager
+    def span(self, name):
+        """
+        Times the enclosed block, adding it to the named span.
+        """
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.add(name, (time.perf_counter() - start) * 1e3)
+
+    def add(self, name, ms):
+        self.spans[name] = self.spans.get(name, 0.0) + ms
+
+    def record(self):
+        """
+        :return: the trace as a flat dictionary for export
+        """
+        record = {"id": self.request_id, "time": round(self.time, 6), "sorter": self.sorter, "request": self.request,
+                  "verdict": self.verdict, "cached": self.cached, "frames": self.frames}
+        record.update({name: round(self.spans[name], 4) if name in self.spans else None for name in SPANS})
+        return record
+
+
+class Metrics:
+    """
+    Collects finished traces into rolling windows per sorter and span, and exports them.
+    Safe to share between every sorter in the process.
+    """
+
+    def __init__(self, window=1000, export_path=None):
+        """
+        :param window: the number of recent requests the percentiles are taken over
+        :param export_path: file to append each finished trace to - CSV if it ends in .csv, otherwise JSON lines
+        """
+        self._window = window
+        self._lock = threading.Lock()
+        self._next_id = 1
+        self._windows = {}      # (sorter, span) -> deque of ms
+        self._requests = {}     # sorter -> requests finished
+        self._cache_hits = {}   # sorter -> requests answered from the cache
+        self._server = None
+
+        self._export = None
+        self._writer = None
+        if export_path is not None:
+            self._export = open(export_path, "a", newline="")
+            if export_path.endswith(".csv"):
+                self._writer = csv.DictWriter(self._export, ["id", "time", "sorter", "request", "verdict", "cached",
+                                                             "frames", *SPANS])
+                if self._export.tell() == 0:
+                    self._writer.writeheader()
+
+    def start(self, sorter, request):
+        """
+        Starts tracing a request.
+        :param sorter: the name of the sorter serving it
+        :param request: the request type, e.g. 'a'
+        :return: the new Trace
+        """
+        with self._lock:
+            request_id = self._next_id
+            self._next_id += 1
+        return Trace(request_id, sorter, request)
+
+    def finish(self, trace):
+        """
+        Ends a trace - its total span is taken now - and records and exports it.
+        """
+        trace.add("total", (time.perf_counter() - trace.start) * 1e3)
+
+        with self._lock:
+            for name, ms in trace.spans.items():
+                self._windows.setdefault((trace.sorter, name), deque(maxlen=self._window)).append(ms)
+            self._requests[trace.sorter] = self._requests.get(trace.sorter, 0) + 1
+            self._cache_hits[trace.sorter] = self._cache_hits.get(trace.sorter, 0) + trace.cached
+
+            if self._writer is not None:
+                self._writer.writerow(trace.record())
+            elif self._export is not None:
+                self._export.write(json.dumps(trace.record()) + "\n")
+            if self._export is not None:
+                self._export.flush()
+
+    def percentiles(self):
+        """
+        :return: Dictionary of (sorter, span) to a dictionary of percentile to ms, over the rolling window
+        """
+        with self._lock:
+            windows = {key: list(values) for key, values in self._windows.items()}
+        return {key: dict(zip(PERCENTILES, np.percentile(values, PERCENTILES))) for key, values in windows.items()}
+
+    def render(self):
+        """
+        :return: the metrics as text, one "name{labels} value" line each
+        """
+        lines = []
+        with self._lock:
+            for sorter, count in sorted(self._requests.items()):
+                lines.append(f'vision_requests_total{{sorter="{sorter}"}} {count}')
+                lines.append(f'vision_cache_hits_total{{sorter="{sorter}"}} {self._cache_hits[sorter]}')
+        for (sorter, span), values in sorted(self.percentiles().items()):
+            for percentile, ms in values.items():
+                lines.append(f'vision_span_ms{{sorter="{sorter}",span="{span}",quantile="0.{percentile}"}} {ms:.4f}')
+        return "\n".join(lines) + "\n"
+
+    def serve(self, port):
+        """
+        Serves render() at http://127.0.0.1:<port>/metrics on a background thread. Only local connections are possible.
+        :param port: the TCP port to listen on
+        """
+        metrics = self
+
+        class Handler(BaseHTTPRequestHandler):
+            def do_GET(self):
+                if self.path != "/metrics":
+                    self.send_error(404)
+                    return
+                body = metrics.render().encode()
+                self.send_response(200)
+                self.send_header("Content-Type", "text/plain; charset=utf-8")
+                self.send_header("Content-Length", str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+            def log_message(self, format, *args):
+                pass  # keep scrapes out of the console
+
+        self._server = ThreadingHTTPServer(("127.0.0.1", port), Handler)
+        threading.Thread(target=self._server.serve_forever, name="Metrics", daemon=True).start()
+
+    def close(self):
+        if self._server is not None:
+            self._server.shutdown()
+            self._server = None
+        with self._lock:
+            if self._export is not None:
+                self._export.close()
+                self._export = None
+                self._writer = None
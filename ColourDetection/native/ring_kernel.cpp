@@ -0,0 +1,160 @@
+/*
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+Native ring sampling and classification kernel for colour_detection.py.
+Converts only the sampled ring pixels from BGR to HSV (bit-exact with OpenCV's 8-bit COLOR_BGR2HSV)
+and counts them into categories in a single call, so the full frame is never converted.
+Build in place with: python setup.py build_ext --inplace
+*/
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+// fixed point shift and division tables used by OpenCV's 8-bit RGB2HSV_b, so results match cv2.cvtColor exactly
+constexpr int HsvShift = 12;
+constexpr int HsvRound = 1 << (HsvShift - 1);
+constexpr int HueRange = 180;
+
+int SatDivTable[256];
+int HueDivTable[256];
+
+void InitTables()
+{
+    SatDivTable[0] = HueDivTable[0] = 0;
+    for (int i = 1; i < 256; ++i)
+    {
+        // saturate_cast<int>(double) in OpenCV rounds half to even, as lrint does
+        SatDivTable[i] = static_cast<int>(std::lrint((255 << HsvShift) / (1. * i)));
+        HueDivTable[i] = static_cast<int>(std::lrint((HueRange << HsvShift) / (6. * i)));
+    }
+}
+
+// counts the sampled pixels into categories
+// frame    : BGR bytes
+// offsets  : byte offset of each sampled pixel in the frame
+// hueLut   : category index for each hue
+// counts   : one counter per category (plus the unreported bin), zeroed by the caller
+// returns false if an offset falls outside the frame
+bool ClassifyRing(const uint8_t *frame, Py_ssize_t frameLen, const int64_t *offsets, Py_ssize_t count,
+                  const uint8_t *hueLut, int satThreshold, int valThreshold, int whiteIndex, int blackIndex,
+                  Py_ssize_t *counts, Py_ssize_t binCount)
+{
+    for (Py_ssize_t i = 0; i < count; ++i)
+    {
+        const int64_t offset = offsets[i];
+        if (offset < 0 || offset + 2 >= frameLen)
+            return false;
+
+        const int b = frame[offset], g = frame[offset + 1], r = frame[offset + 2];
+
+        // value and saturation
+        const int v = std::max(b, std::max(g, r));
+        const int diff = v - std::min(b, std::min(g, r));
+        const int s = (diff * SatDivTable[v] + HsvRound) >> HsvShift;
+
+        int category;
+        if (s > satThreshold)
+        {
+            // hue, branch-free as in OpenCV: which channel is the max selects the hue sector
+            const int vr = v == r ? -1 : 0;
+            const int vg = v == g ? -1 : 0;
+            int h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * diff)) + (~vg & (r - g + 4 * diff))));
+            h = (h * HueDivTable[diff] + HsvRound) >> HsvShift;
+            h += h < 0 ? HueRange : 0;
+            category = hueLut[h];
+        }
+        else
+            category = v > valThreshold ? whiteIndex : blackIndex;
+
+        // anything outside the table lands in the unreported last bin
+        if (category >= binCount)
+            category = static_cast<int>(binCount - 1);
+        ++counts[category];
+    }
+    return true;
+}
+
+// classify(frame, offsets, hue_lut, sat_threshold, val_threshold, white_index, black_index, bin_count) -> list
+PyObject *Classify(PyObject *, PyObject *args)
+{
+    Py_buffer frame, offsets, hueLut;
+    int satThreshold, valThreshold, whiteIndex, blackIndex;
+    Py_ssize_t binCount;
+
+    if (!PyArg_ParseTuple(args, "y*y*y*iiiin", &frame, &offsets, &hueLut, &satThreshold, &valThreshold,
+                          &whiteIndex, &blackIndex, &binCount))
+        return nullptr;
+
+    PyObject *result = nullptr;
+    if (offsets.len % sizeof(int64_t) || hueLut.len != 256 || binCount < 1 || whiteIndex < 0 ||
+        blackIndex < 0 || whiteIndex >= binCount || blackIndex >= binCount)
+    {
+        PyErr_SetString(PyExc_ValueError, "offsets must be int64, hue_lut 256 bytes, indexes within bin_count");
+    }
+    else
+    {
+        std::vector<Py_ssize_t> counts(static_cast<size_t>(binCount), 0);
+        bool inFrame;
+
+        // pure C++ from here, so other threads (capture, serial) keep running
+        Py_BEGIN_ALLOW_THREADS
+        inFrame = ClassifyRing(static_cast<const uint8_t *>(frame.buf), frame.len,
+                               static_cast<const int64_t *>(offsets.buf), offsets.len / (Py_ssize_t)sizeof(int64_t),
+                               static_cast<const uint8_t *>(hueLut.buf), satThreshold, valThreshold, whiteIndex,
+                               blackIndex, counts.data(), binCount);
+        Py_END_ALLOW_THREADS
+
+        if (!inFrame)
+            PyErr_SetString(PyExc_ValueError, "ring offset outside the frame");
+        else
+        {
+            result = PyList_New(binCount);
+            for (Py_ssize_t i = 0; result && i < binCount; ++i)
+            {
+                PyObject *count = PyLong_FromSsize_t(counts[static_cast<size_t>(i)]);
+                if (!count)
+                {
+                    // the unset items are NULL, which the list's dealloc skips
+                    Py_CLEAR(result);
+                    break;
+                }
+                PyList_SET_ITEM(result, i, count);
+            }
+        }
+    }
+
+    PyBuffer_Release(&frame);
+    PyBuffer_Release(&offsets);
+    PyBuffer_Release(&hueLut);
+    return result;
+}
+
+PyMethodDef RingKernelMethods[] = {
+    {"classify", Classify, METH_VARARGS,
+     "classify(frame, offsets, hue_lut, sat_threshold, val_threshold, white_index, black_index, bin_count)\n"
+     "Converts the BGR pixels at the int64 byte offsets to HSV and returns the count per category."},
+    {nullptr, nullptr, 0, nullptr}};
+
+// every field given (no designated initialisers before C++20), so -Wextra has nothing to report
+PyModuleDef RingKernelModule = {PyModuleDef_HEAD_INIT,
+                                "ring_kernel",
+                                "Native ring sampling and classification kernel.",
+                                -1,
+                                RingKernelMethods,
+                                nullptr,  // m_slots
+                                nullptr,  // m_traverse
+                                nullptr,  // m_clear
+                                nullptr}; // m_free
+} // namespace
+
+PyMODINIT_FUNC PyInit_ring_kernel(void)
+{
+    InitTables();
+    return PyModule_Create(&RingKernelModule);
+}
@@ -0,0 +1,100 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the serial request service used by the vision service.
+A dedicated thread blocks on the serial port and dispatches each request as soon as its byte arrives,
+so reply latency depends only on the time taken to handle the request.
+"""
+import threading
+import time
+import traceback
+
+
+class SerialService:
+    """
+    Reads single byte requests from a serial port on a background thread and writes back each handler's reply.
+    """
+
+    def __init__(self, ser, handlers, after_reply=None, fallbacks=None, on_request=None):
+        """
+        :param ser: the open serial port, its read timeout bounds how long stop() waits for the thread
+        :param handlers: Dictionary of request byte (e.g. b'a') to a callable returning the reply bytes, or None for no reply
+        :param after_reply: callable taking the ms spent writing the reply, called after each handled request, or None
+        :param fallbacks: Dictionary of request byte to the reply sent when its handler raises, so the other device
+        is never left waiting - a request without one gets no reply
+        :param on_request: callable taking the request byte, called as soon as a request's byte is read,
+        before its handler, or None
+        """
+        self._ser = ser
+        self._handlers = handlers
+        self._after_reply = after_reply
+        self._fallbacks = fallbacks or {}
+        self._on_request = on_request
+        self._running = False
+        self._thread = None
+        self.requests = 0   # requests handled
+        self.ignored = 0    # bytes received that are not requests
+        self.errors = 0     # requests whose handler raised, answered with the fallback reply
+
+    def start(self):
+        """
+        Starts the serial thread.
+        :return: this service, so it can be started where it is created
+        """
+        self._running = True
+        self._thread = threading.Thread(target=self._serve, name="SerialService", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        """
+        Stops the serial thread once its current read or request finishes.
+        """
+        self._running = False
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+
+    def join(self, timeout=None):
+        """
+        Waits for the serial thread to end.
+        :param timeout: seconds to wait, None waits forever
+        :return: True if the thread is still running
+        """
+        if self._thread is not None:
+            self._thread.join(timeout)
+            return self._thread.is_alive()
+        return False
+
+    def _serve(self):
+        """
+        Serial thread - blocks for each request byte and handles it immediately.
+        """
+        while self._running:
+            # blocks until a byte arrives, the port timeout only lets the thread notice stop()
+            request = self._ser.read(1)
+            if not request:
+                continue
+
+            handler = self._handlers.get(request)
+            if handler is None:
+                self.ignored += 1
+                continue
+
+            try:
+                if self._on_request is not None:
+                    self._on_request(request)
+                reply = handler()
+            except Exception:
+                # keep serving - a failed request is answered with its fallback instead of ending the thread
+                self.errors += 1
+                reply = self._fallbacks.get(request)
+                print(f"SerialService: request {request!r} failed, replying {reply!r}")
+                traceback.print_exc()
+            self.requests += 1
+
+            start = time.perf_counter()
+            if reply:
+                self._ser.write(reply)
+            if self._after_reply is not None:
+                self._after_reply((time.perf_counter() - start) * 1e3)
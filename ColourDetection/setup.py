@@ -0,0 +1,17 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+Builds the optional native ring kernel used by colour_detection.py.
+Build in place (next to colour_detection.py) with: python setup.py build_ext --inplace
+colour_detection.py falls back to the NumPy implementation when the kernel is not built.
+"""
+import sys
+
+from setuptools import setup, Extension
+
+compile_args = ["/O2", "/std:c++17"] if sys.platform == "win32" else ["-O3", "-std=c++17"]
+
+setup(
+    name="ring_kernel",
+    ext_modules=[Extension("ring_kernel", ["native/ring_kernel.cpp"], extra_compile_args=compile_args)],
+)
@@ -0,0 +1,242 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the vision service for one sorter: its camera, chip watcher and serial link.
+Analysis runs on the sorter's own threads, or on a worker pool shared by every sorter in the process.
+"""
+import time
+
+import colour_detection as cd
+from chip_watcher import ChipWatcher
+from frame_grabber import FrameGrabber
+from frame_ring import FrameSubscriber
+from metrics import Metrics
+from serial_service import SerialService
+
+# histogram reply layout - the colour byte, the margin, then the share of each category in this order,
+# each quantised to a byte (0-255); fixed so the board can decode it without a length (see lib/ChipColour.h)
+# colour table configs are limited to these categories, so a hot swap cannot drop a share from the reply
+HISTOGRAM_CATEGORIES = cd.BOARD_CATEGORIES
+HISTOGRAM_BYTES = 2 + len(HISTOGRAM_CATEGORIES)
+
+
+def colour_code(colour):
+    """
+    Encodes a colour as the single byte sent back to the other device.
+    r=Red, g=Green, b=Blue, w=White, k=Black, o=Other
+    k is used for black because b is used for blue and simplifying to a single byte is simpler to process
+    :param colour: the colour name from analyse_categories
+    :return: the encoded colour byte
+    """
+    match colour:
+        case 'red':
+            ser_out = 'r'
+        case 'green':
+            ser_out = 'g'
+        case 'blue':
+            ser_out = 'b'
+        case 'white':
+            ser_out = 'w'
+        case 'black':
+            ser_out = 'k'
+        case other:
+            ser_out = 'o'
+    return ser_out.encode()
+
+
+def quantise(share):
+    """
+    Quantises a share or margin from 0 to 1 into a byte, 255 being 1.
+    """
+    return min(255, max(0, round(share * 255)))
+
+
+def histogram_reply(decision):
+    """
+    Encodes a decision as the fixed size histogram reply, so the other device can apply its own policy.
+    :param decision: the Decision to encode
+    :return: HISTOGRAM_BYTES bytes - the colour byte, the quantised margin,
+    then the quantised share of each of HISTOGRAM_CATEGORIES (0 for a category not reported)
+    """
+    shares = [quantise(decision.shares.get(name, 0.0)) for name in HISTOGRAM_CATEGORIES]
+    return colour_code(decision.colour) + bytes([quantise(decision.margin)] + shares)
+
+
+class Sorter:
+    """
+    Serves one sorter: drains its camera, analyses each chip as it settles, and answers its serial requests.
+    Requests are 'a' - analyse the chip in the slot, replied with its colour byte,
+    'h' - the same analysis, replied with the histogram reply (colour byte, margin and category shares) - and,
+    when tray slots are set, 't' - analyse every tray slot from one frame, replied with the slot count byte
+    then a colour byte per slot.
+    """
+
+    def __init__(self, name, ser, cam, geometry=cd.DEFAULT_RING, pool=None, recorder=None, slots=None, metrics=None,
+                 locator=None):
+        """
+        :param name: the name printed with this sorter's results
+        :param ser: the open serial port to the sorter
+        :param cam: the opened camera (or stand-in source) viewing the sorter's slot,
+        or a FrameSubscriber to take frames published by another process
+        :param geometry: the RingGeometry of the chip in the camera image
+        :param pool: the concurrent.futures executor to analyse on, None to analyse on the calling thread
+        :param recorder: the DebugRecorder to offer analysed frames to, or None
+        :param slots: sequence of RingGeometry, one per staging tray slot in view, or None for no tray
+        :param metrics: the Metrics to trace requests into, shared between sorters, None for this sorter's own
+        :param locator: the ChipLocator to centre a narrow sampling band on the chip with,
+        None to always sample the given geometry
+        """
+        self.name = name
+        self.geometry = geometry
+        self._pool = pool
+        self._recorder = recorder
+        self.locator = locator
+        self.metrics = metrics if metrics is not None else Metrics()
+        self._trace = None  # the request being served, only used on the serial thread
+
+        # a subscriber already serves the latest frame, anything else is a camera to drain
+        self.grabber = cam if isinstance(cam, FrameSubscriber) else FrameGrabber(cam)
+        self.watcher = ChipWatcher(self.grabber, self._analyse, geometry)
+        self.slots = tuple(slots or ())
+
+        handlers = {b'a': self.analyse_request, b'h': self.histogram_request}
+        # a request that fails is answered as Other with no confidence, so the board sorts the chip aside
+        other = cd.Decision("other", 0.0, 0, {})
+        fallbacks = {b'a': colour_code(other.colour), b'h': histogram_reply(other)}
+        if self.slots:
+            handlers[b't'] = self.analyse_tray
+            fallbacks[b't'] = bytes([len(self.slots)]) + colour_code(other.colour) * len(self.slots)
+        self.service = SerialService(ser, handlers, self._finish_trace, fallbacks, on_request=self._start_trace)
+
+    def start(self):
+        """
+        Starts capture, waits for the first frame, then starts watching and serving requests.
+        :return: this sorter, so it can be started where it is created
+        """
+        self.grabber.start()
+        self.grabber.wait_for_frame()
+        self.watcher.start()
+        self.service.start()
+        return self
+
+    def stop(self):
+        self.service.stop()
+        self.watcher.stop()
+        self.grabber.stop()
+
+    def analyse_frame(self, img, timestamp, trace=None):
+        """
+        Analyses a frame, voting over further frames on close calls within the vote time budget.
+        :param img: the BGR frame to analyse
+        :param timestamp: the frame's monotonic capture timestamp
+        :param trace: the Trace of the request being served, None for a speculative analysis
+        :return: the Decision
+        """
+        classify = self._classify
+        if trace is not None:
+            def classify(frame):
+                with trace.span("classify"):
+                    return self._classify(frame, trace)
+
+        decision = cd.decide_with_voting(self.grabber, img, timestamp, classify, trace=trace)
+        print(f"{self.name} results:")
+        print(decision.shares)
+
+        if self._recorder is not None:
+            self._recorder.record(img, decision.colour, decision.margin)
+
+        return decision
+
+    def analyse_request(self):
+        """
+        Handles an analysis request - answers from the chip watcher's cached verdict when the chip has not changed,
+        otherwise analyses the latest frame, and returns the colour byte to send back.
+        :return: the encoded colour byte
+        """
+        return colour_code(self._decide().colour)
+
+    def histogram_request(self):
+        """
+        Handles a histogram request - decides the chip as analyse_request does, replying with the whole decision.
+        :return: the histogram reply
+        """
+        return histogram_reply(self._decide())
+
+    def _decide(self):
+        """
+        Decides the chip in the slot for a request, from the cached verdict or the latest frame, tracing it.
+        :return: the Decision
+        """
+        # print("Processing...")  # debug line
+        trace = self._trace
+        with trace.span("cache"):
+            hit = self.watcher.cached()
+
+        if hit is not None:
+            decision, timestamp = hit
+        else:
+            with trace.span("capture"):
+                img, timestamp = self.grabber.latest()
+            with trace.span("analyse"):
+                decision = self._analyse(img, timestamp, trace)
+        trace.add("frame_age", (time.monotonic() - timestamp) * 1e3)
+
+        colour = decision.colour
+        trace.verdict, trace.cached, trace.frames = colour, hit is not None, decision.frames
+        print(f"{self.name}: the chip is {colour} (margin {decision.margin:.2f} over {decision.frames} frame(s)"
+              f"{', cached' if hit is not None else ''})")
+
+        return decision
+
+    def analyse_tray(self):
+        """
+        Handles a tray request - classifies every tray slot from the latest frame in one pass.
+        :return: the slot count byte followed by the encoded colour byte of each slot, in slot order
+        """
+        trace = self._trace
+        with trace.span("capture"):
+            img, timestamp = self.grabber.latest()
+        trace.add("frame_age", (time.monotonic() - timestamp) * 1e3)
+
+        with trace.span("analyse"):
+            if self._pool is None:
+                results = cd.classify_rings(img, self.slots, trace=trace)
+            else:
+                results = self._pool.submit(cd.classify_rings, img, self.slots, trace=trace).result()
+
+        colours = [cd.analyse_categories(categories) for categories in results]
+        trace.verdict, trace.frames = "".join(colour_code(colour).decode() for colour in colours), 1
+        print(f"{self.name}: the tray holds {', '.join(colours)}")
+
+        return bytes([len(colours)]) + b"".join(colour_code(colour) for colour in colours)
+
+    def _classify(self, img, trace=None):
+        """
+        Classifies the chip ring in a frame, on the located band when there is a locator.
+        """
+        geometry = self.locator.geometry(img) if self.locator is not None else self.geometry
+        return cd.classify_ring_progressive(img, geometry=geometry, trace=trace)
+
+    def _analyse(self, img, timestamp, trace=None):
+        """
+        Runs analyse_frame on the shared pool when there is one, waiting for the result.
+        """
+        if self._pool is None:
+            return self.analyse_frame(img, timestamp, trace)
+        return self._pool.submit(self.analyse_frame, img, timestamp, trace).result()
+
+    def _start_trace(self, request):
+        """
+        Called by the serial thread as soon as a request byte arrives - starts the request's trace,
+        so its total covers the whole time the other device waits.
+        """
+        self._trace = self.metrics.start(self.name, request.decode())
+
+    def _finish_trace(self, write_ms):
+        """
+        Called by the serial thread once a reply is written - completes the request's trace.
+        """
+        if self._trace is not None:
+            self._trace.add("serial_write", write_ms)
+            self.metrics.finish(self._trace)
+            self._trace = None
@@ -0,0 +1,99 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This module contains the colour table watcher used to retune the vision service while it runs.
+The colour table config file is polled for changes; a changed file is loaded, checked and compiled off the
+request path, then installed in one swap, so new lighting can be tuned in without a restart.
+A config that fails to load or check is reported and the current tables are kept.
+"""
+import os
+import threading
+
+import colour_detection as cd
+
+# seconds between checks of the config file
+POLL_INTERVAL = 1.0
+
+
+class TablesWatcher:
+    """
+    Reloads the colour classification tables whenever their config file changes.
+    """
+
+    def __init__(self, path, interval=POLL_INTERVAL):
+        """
+        :param path: the colour table config file (see colour_tables.example.json)
+        :param interval: seconds between checks of the file
+        """
+        self.path = path
+        self.interval = interval
+        self._stamp = None  # (mtime, size) of the file last installed
+        self._failed = None  # (mtime, size) of the file last failed, so it is reported once
+        self._stop = threading.Event()
+        self._thread = None
+        self.reloads = 0  # tables installed after the first load
+        self.failures = 0  # changed files that failed to load
+
+    def start(self):
+        """
+        Loads and installs the tables from the file, then starts watching it.
+        A config that fails to load here raises, so a bad file is caught before the service starts.
+        :return: this watcher, so it can be started where it is created
+        """
+        stamp = self._file_stamp()
+        cd.install_tables(cd.load_tables(self.path))
+        self._stamp = stamp
+
+        self._stop.clear()
+        self._thread = threading.Thread(target=self._watch, name="TablesWatcher", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._stop.set()
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+
+    def check(self):
+        """
+        Reloads the tables if the file has changed since they were last installed.
+        :return: True if new tables were installed
+        """
+        try:
+            stamp = self._file_stamp()
+        except OSError:
+            return False  # mid-replace or removed, keep the current tables until it is back
+        if stamp == self._stamp or stamp == self._failed:
+            return False
+
+        try:
+            tables = cd.load_tables(self.path)
+        except Exception as error:
+            # a partly written file is retried once it changes again
+            self._failed = stamp
+            self.failures += 1
+            print(f"Colour tables: {self.path} not loaded, keeping the current tables ({error})")
+            return False
+
+        cd.install_tables(tables)
+        self._stamp = stamp
+        self.reloads += 1
+        print(f"Colour tables: reloaded from {self.path} - {', '.join(tables.categories)}")
+        return True
+
+    def _watch(self):
+        """
+        Watcher thread - checks the file every interval until stopped.
+        """
+        while not self._stop.wait(self.interval):
+            try:
+                self.check()
+            except Exception as error:
+                # never let a bad file end hot reloading - report it and keep watching
+                self.failures += 1
+                print(f"Colour tables: checking {self.path} failed, keeping the current tables ({error!r})")
+
+    def _file_stamp(self):
+        stat = os.stat(self.path)
+        return stat.st_mtime_ns, stat.st_size
@@ -0,0 +1,107 @@
+"""
+Author: Andrew Belter
+Creation Date: Oct. 19, 2026
+This program serves several sorters from one process.
+Each sorter in the config gets its own serial port, camera capture thread, chip watcher and ring geometry,
+and every sorter's analysis runs on one shared worker pool sized to the machine's cores.
+Usage: python vision_host.py <config.json>
+See vision_host.example.json for the config format - "camera" takes camera.CameraConfig fields
+and "ring" takes colour_detection.RingGeometry fields, both optional.
+"metrics_export" appends request traces to a file (.csv or JSON lines) and "metrics_port" serves them
+at http://127.0.0.1:<port>/metrics, both optional.
+A sorter with "locate": true samples a narrow band centred on its located chip, using "ring" until one is found.
+A sorter with a staging tray in view lists its slots in "slots", each with RingGeometry fields.
+"colour_tables" names a colour table config (see colour_tables.example.json) shared by every sorter,
+reloaded whenever the file changes; optional, the built-in colour ranges are used without it.
+"""
+import json
+import os
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+import serial
+
+import colour_detection as cd
+from camera import CameraConfig, describe_camera, open_camera
+from chip_locator import ChipLocator
+from debug_recorder import DebugRecorder
+from metrics import Metrics
+from sorter import Sorter
+from tables_watcher import TablesWatcher
+
+
+def load_config(path):
+    """
+    Reads the sorter config.
+    :param path: the JSON config file
+    :return: the config dictionary
+    """
+    with open(path) as file:
+        config = json.load(file)
+    if not config.get("sorters"):
+        raise ValueError(f"{path} lists no sorters")
+    return config
+
+
+def ring_geometry(ring):
+    """
+    :param ring: the "ring" config of a sorter, None for the default
+    :return: the RingGeometry, with the center as a tuple so it can be cached
+    """
+    ring = dict(ring or {})
+    if ring.get("center") is not None:
+        ring["center"] = tuple(ring["center"])
+    return cd.RingGeometry(**ring)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        raise SystemExit("Usage: python vision_host.py <config.json>")
+    config = load_config(sys.argv[1])
+
+    tables_watcher = TablesWatcher(config["colour_tables"]).start() if config.get("colour_tables") else None
+
+    # the analysis threads spend their time in OpenCV and the native kernel, which run without the GIL
+    pool = ThreadPoolExecutor(max_workers=config.get("workers") or os.cpu_count(), thread_name_prefix="Analysis")
+
+    recorder = None
+    if config.get("debug_record_dir"):
+        recorder = DebugRecorder(config["debug_record_dir"]).start()
+
+    metrics = Metrics(export_path=config.get("metrics_export"))
+    if config.get("metrics_port"):
+        metrics.serve(config["metrics_port"])
+
+    sorters = []
+    for index, entry in enumerate(config["sorters"]):
+        name = entry.get("name", f"sorter{index}")
+        ser = serial.Serial(port=entry["port"], baudrate=entry.get("baudrate", 9600), timeout=1)
+        cam = open_camera(CameraConfig(**entry.get("camera", {})))
+        print(f"{name}: {entry['port']}, camera {describe_camera(cam)}")
+
+        geometry = ring_geometry(entry.get("ring"))
+        slots = [ring_geometry(slot) for slot in entry.get("slots", [])]
+        locator = ChipLocator(geometry) if entry.get("locate") else None
+        sorters.append(Sorter(name, ser, cam, geometry, pool, recorder, slots, metrics, locator).start())
+
+    # run until the user manually stops the program, or any sorter's serial thread ends (e.g. its port is lost)
+    # every sorter is checked each pass, so one that dies is never left silently unserved
+    stopped = []
+    try:
+        while not stopped:
+            stopped = [sorter.name for sorter in sorters if not sorter.service.join(1 / len(sorters))]
+        print(f"Serial service ended for {', '.join(stopped)} - stopping every sorter")
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for sorter in sorters:
+            sorter.stop()
+        pool.shutdown()
+        if tables_watcher is not None:
+            tables_watcher.stop()
+        metrics.close()
+        if recorder is not None:
+            recorder.stop()
+
+    if stopped:
+        raise SystemExit(1)
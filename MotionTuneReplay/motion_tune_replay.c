@@ -0,0 +1,126 @@
+/* ////////////////////////////////////////////////////////////////////////////
+// PC Program:    CMPE2965 - Poker Chip Sorter Motion Tuning Replay
+// Author:        Andrew Belter
+// Details:       Replays a recorded motion tuning run (the SCI0 stream from the Motion Tuning
+//                test in PokerChipSorter_Testing) through the same MotionTune library the board
+//                uses, and checks the settle results and selected profile against the recording.
+//                Build and run on a PC:
+//                  gcc -I../lib -o motion_tune_replay motion_tune_replay.c ../lib/MotionTune.c
+//                  motion_tune_replay <recording.txt> [tolerance] [maxSettleSamples]
+//                tolerance and maxSettleSamples default to the Testing project's constants.
+// Date:          Oct. 19, 2026
+/////////////////////////////////////////////////////////////////////////// */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MotionTune.h"
+
+// recording line formats (one per line, \r\n terminated):
+//  M,<profile>,<startPeriod_us>,<cruisePeriod_us>,<rampStep_us>  - test move started
+//  S,<x>,<y>,<z>                                               - accelerometer sample after the move
+//  R,<profile>,<settleSamples>,<settled>                       - board's result for the move
+//  P,<selected profile>                                        - board's selected profile (-1 = none)
+
+// defaults matching the Testing project
+const int DefaultTolerance = 40;
+const unsigned int DefaultMaxSettleSamples = 40;
+
+// analyses the samples collected for a move and records the result in the search
+// returns the number of samples the replay took to settle
+unsigned int FinishMove(int profile, int tolerance, unsigned int maxSettleSamples, unsigned char *pKeepSearching)
+{
+    unsigned int settleSamples = Tune_SettleSamples(tolerance);
+
+    *pKeepSearching = Tune_RecordResult(settleSamples, maxSettleSamples);
+    printf("profile %d: %u samples, settle after %u (%s)\n", profile, Tune_SampleCount(), settleSamples,
+           settleSamples <= maxSettleSamples ? "settled" : "not settled");
+    return settleSamples;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *pFile;
+    char line[128];
+    int tolerance = DefaultTolerance;
+    unsigned int maxSettleSamples = DefaultMaxSettleSamples;
+    int profile = -1;             // profile of the move being collected, -1 = none
+    unsigned int settleSamples = 0;
+    unsigned char keepSearching = 1;
+    int mismatches = 0;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <recording.txt> [tolerance] [maxSettleSamples]\n", argv[0]);
+        return 2;
+    }
+    if (argc > 2)
+        tolerance = atoi(argv[2]);
+    if (argc > 3)
+        maxSettleSamples = (unsigned int)atoi(argv[3]);
+
+    pFile = fopen(argv[1], "r");
+    if (!pFile)
+    {
+        fprintf(stderr, "can't open %s\n", argv[1]);
+        return 2;
+    }
+
+    Tune_StartSearch();
+    while (fgets(line, sizeof(line), pFile))
+    {
+        int a, b, c, d;
+
+        switch (line[0])
+        {
+        case 'M':
+            if (sscanf(line, "M,%d,%d,%d,%d", &a, &b, &c, &d) != 4)
+                break;
+            // recordings without R lines still get every move analysed
+            if (profile >= 0 && keepSearching)
+                (void)FinishMove(profile, tolerance, maxSettleSamples, &keepSearching);
+            profile = a;
+            Tune_Reset();
+            break;
+        case 'S':
+            if (profile >= 0 && sscanf(line, "S,%d,%d,%d", &a, &b, &c) == 3)
+                (void)Tune_AddSample(a, b, c);
+            break;
+        case 'R':
+            if (profile < 0 || sscanf(line, "R,%d,%d,%d", &a, &b, &c) != 3)
+                break;
+            settleSamples = FinishMove(profile, tolerance, maxSettleSamples, &keepSearching);
+            if ((unsigned int)b != settleSamples)
+            {
+                printf("  mismatch: board reported settle after %d\n", b);
+                ++mismatches;
+            }
+            profile = -1;
+            break;
+        case 'P':
+            if (sscanf(line, "P,%d", &a) != 1)
+                break;
+            if (a != Tune_SelectedProfile())
+            {
+                printf("mismatch: board selected profile %d\n", a);
+                ++mismatches;
+            }
+            break;
+        }
+    }
+    fclose(pFile);
+
+    // last move of a recording without R lines
+    if (profile >= 0 && keepSearching)
+        (void)FinishMove(profile, tolerance, maxSettleSamples, &keepSearching);
+
+    printf("selected profile: %d\n", Tune_SelectedProfile());
+    if (Tune_SelectedProfile() >= 0)
+    {
+        Tune_Profile selected = Tune_GetProfile((unsigned char)Tune_SelectedProfile());
+        printf("  start %u us, cruise %u us, ramp %u us/step\n", selected.startPeriod_us,
+               selected.cruisePeriod_us, selected.rampStep_us);
+    }
+    printf("%d mismatch(es) with the recording\n", mismatches);
+
+    return mismatches ? 1 : 0;
+}
@@ -18,6 +18,10 @@
 #include "swled.h"      /* switches and LEDs */
 #include "timer.h"      /* timer library */
 #include "pulse.h"      /* PWM Library */
+#include "atod.h"       /* AtoD library */
+#include "i2c.h"        /* I2C library */
+#include "TCS34725.h"   /* colour sensor library */
+#include "ChipColour.h" /* on board colour classification */
 
 // other system includes or your includes go here
 // #include <stdlib.h>
@@ -62,13 +66,25 @@ typedef enum OperatingState
   State_Deliver
 } OperatingState;
 
+// where the Analyse state gets the chip colour from
+typedef enum ColourProvider
+{
+  Provider_Vision,          // PC vision service over SCI0, replying with the colour byte
+  Provider_VisionHistogram, // PC vision service over SCI0, replying with its histogram for the board to decide
+  Provider_Sensor           // I2C colour sensor, classified on the board
+} ColourProvider;
+
 /////////////////////////////////////////////////////////////////////////////
 // Local Prototypes
 /////////////////////////////////////////////////////////////////////////////
 
 void UpdateDisplay(void);
 void IsolateChip(void);
+void EmptyStrokeBackoff(void);
 void DetermineColour(void);
+void DetermineColourHistogram(void);
+int InitColourSensor(void);
+void SenseColour(void);
 void UpdateColour(Colours colour);
 void ResetCount(void);
 
@@ -82,14 +98,37 @@ volatile OperatingState opState = State_Isolate;
 volatile unsigned int ChipCount[6] = {0};
 volatile unsigned int lockout = 0;
 volatile unsigned char needDisplayUpdate = 1;
+volatile unsigned int idleTicks = 0; // PIT0 ticks left to idle before the next isolation attempt
+unsigned char towerEmpty = 0;        // 1 = too many empty isolator strokes in a row, tower needs a refill
+unsigned char emptyStrokes = 0;      // consecutive isolator strokes that produced no chip
+unsigned int emptyBackoff_ms = 0;    // current wait between empty isolator strokes
+ColourProvider colourProvider;       // provider in use, falls back to vision if the sensor is missing
+unsigned char sensorRaw[TCS34725_READ_BYTES]; // target of the queued sensor read - the IIC0 ISR fills it, so it outlives SenseColour
+volatile unsigned char gripFailed = 0; // 1 = the last pickup got no grip and stopped operation, cleared by the next grip
 
 /////////////////////////////////////////////////////////////////////////////
 // Constants
 /////////////////////////////////////////////////////////////////////////////
 
-const unsigned long GlobalBusRate = 20E6; // the board bus rate
-const unsigned int MinServoDuty = 350;    // min servo duty cycle for lowest servo position
-const unsigned int MaxServoDuty = 1250;   // max servo duty cycle for furthest servo position
+const unsigned long GlobalBusRate = 20E6;     // the board bus rate
+const unsigned int MinServoDuty = 350;        // min servo duty cycle for lowest servo position
+const unsigned int MaxServoDuty = 1250;       // max servo duty cycle for furthest servo position
+const unsigned int GripTimeout_ms = 1000;     // longest wait for the vacuum sensor to confirm a grip
+const unsigned int ReleaseTimeout_ms = 500;   // longest wait for the vacuum to drop after releasing
+const unsigned int PIT0Interval_ms = 15;      // PIT0 tick for debounce lockout and idle back-off
+const unsigned char MaxEmptyStrokes = 3;      // empty strokes in a row before the tower is reported empty
+const unsigned int MinEmptyBackoff_ms = 250;  // first wait after an empty stroke
+const unsigned int MaxEmptyBackoff_ms = 4000; // back-off doubles up to this wait while the tower is empty
+const unsigned int StepPause_ms = 0;          // debug pause after each step to follow it on the LCD, 0 for none
+
+const ColourProvider SelectedProvider = Provider_Vision;         // colour provider to use
+const TCS34725_IntTime SensorIntTime = TCS34725_IntTime_24ms;    // colour sensor integration time
+const TCS34725_Gain SensorGain = TCS34725_Gain_4x;               // colour sensor gain
+const unsigned int SensorSettle_ms = 50;                         // two integrations, so one runs entirely with the chip at rest
+const unsigned int SensorReadTimeout_us = 2000;                  // longest wait for the queued sensor read
+const ChipColour_Reading SensorWhite = {6200, 2400, 2300, 1900}; // white chip reading (clear, red, green, blue) - re-measure for new lighting
+const unsigned char SensorStream = 0;                            // 1 = stream sensor readings over SCI0 (W/C lines) for ChipColourReplay, debug only - SCI0 is the vision link
+const unsigned char MinVisionMargin = 51;                        // histogram margin (255 = all samples) below which a chip is sorted as Other
 
 /////////////////////////////////////////////////////////////////////////////
 // Main Entry
@@ -115,7 +154,14 @@ void main(void)
   Cap_PortAInit();
   PortJ_Init(PortJ_Option_On, PortJ_Option_On);
   Pulse_Init_16Bit(Pulse_Channel7, Pulse_PrescaleStage1_1, 20, Pulse_PolatityPositive, 10000, 0);
-  PIT_Init(PIT_Channel_0, PIT_Interrupt_On, GlobalBusRate, 15000);
+  PIT_Init(PIT_Channel_0, PIT_Interrupt_On, GlobalBusRate, PIT0Interval_ms * 1000UL);
+  AtoD_Init(AtoD_InterruptsOn); // sensors are read from the ISR-filtered averages
+  SCI0_Init(GlobalBusRate, BaudRate_9600, SCI_RDRF_InterruptOff); // SCI0 @ 9600 baud to the vision service
+
+  // use the colour sensor if selected and present, otherwise the vision service
+  colourProvider = SelectedProvider;
+  if (colourProvider == Provider_Sensor && InitColourSensor())
+    colourProvider = Provider_Vision;
 
   /////////////////////////////////////////////////////////////////////////////
   // main program loop
@@ -148,32 +194,56 @@ void main(void)
     switch (opState)
     {
     case State_Isolate:
-      // chip isolator
-      // IsolateChip();
+      // chip isolator - only move on to analysis once a chip is confirmed in the slot
+      IsolateChip();
+      if (!Cap_ChipPresent())
+      {
+        EmptyStrokeBackoff();
+        break;
+      }
+      emptyStrokes = 0;
+      emptyBackoff_ms = 0;
+      towerEmpty = 0;
       opState = State_Analyse;
       break;
     case State_Analyse:
-      // colour detection
-      // DetermineColour();
-      PIT_Sleep_ms(PIT_Channel_1, GlobalBusRate, 3000); // dummy code
-      UpdateColour(Colour_Red);                         // dummy code
+      // colour detection - on the board from the colour sensor, or a round-trip to the vision service
+      if (colourProvider == Provider_Sensor)
+        SenseColour();
+      else if (colourProvider == Provider_VisionHistogram)
+        DetermineColourHistogram();
+      else
+        DetermineColour();
       opState = State_Pickup;
       break;
     case State_Pickup:
       // move to chip
 
-      // Cap_PortASet(PumpControl); // pump on
+      // pump on and lift as soon as the vacuum sensor confirms the grip
+      if (Cap_PumpGrip(GripTimeout_ms))
+      {
+        // no grip within the timeout - pump off and stop so the slot can be checked
+        // restarting (PJ0) resumes here to retry the pickup
+        Cap_PortAClear(PumpControl);
+        gripFailed = 1;
+        IsRunning = 0;
+        break;
+      }
+      gripFailed = 0;
       opState = State_Deliver;
       break;
     case State_Deliver:
       // move to container
 
-      // Cap_PortAClear(PumpControl); // pump off
+      // pump off and leave the container as soon as the vacuum has dropped
+      // a release timeout is not fatal - the chip falls once the cup vents regardless
+      (void)Cap_PumpRelease(ReleaseTimeout_ms);
       opState = State_Isolate;
       break;
     }
 
-    PIT_Sleep_ms(PIT_Channel_1, GlobalBusRate, 3000); // dummy code
+    if (StepPause_ms)
+      PIT_Sleep_ms(PIT_Channel_1, GlobalBusRate, StepPause_ms);
 
     // yellow on for operation step end
     SWLClear(SWLYellow);
@@ -213,7 +283,7 @@ void UpdateDisplay()
     LCD_StringXY(0, 0, "Poker Chip Sorter   ");
     LCD_StringXY(0, 1, "Op State : Stopped  ");
     LCD_StringXY(0, 2, "Press PJ0 to Start  ");
-    LCD_StringXY(0, 3, "                    ");
+    LCD_StringXY(0, 3, gripFailed ? "No grip - check slot" : "                    ");
     return;
   }
 
@@ -224,7 +294,7 @@ void UpdateDisplay()
     LCD_StringXY(0, 0, "Poker Chip Sorter   ");
     LCD_StringXY(0, 1, "Op State : Isolate  ");
     LCD_StringXY(0, 2, "Isolating a chip    ");
-    LCD_StringXY(0, 3, "                    ");
+    LCD_StringXY(0, 3, towerEmpty ? "Tower empty - refill" : "                    ");
     break;
   case State_Analyse:
     LCD_StringXY(0, 0, "Poker Chip Sorter   ");
@@ -256,9 +326,35 @@ void IsolateChip(void)
   PIT_Sleep_ms(PIT_Channel_1, GlobalBusRate, 500);
 }
 
+// Called after an isolator stroke that produced no chip
+// idles (wai) for the current back-off, doubling it each empty stroke up to the max,
+// and reports the tower as empty once too many strokes in a row have come up empty
+void EmptyStrokeBackoff(void)
+{
+  if (emptyStrokes < MaxEmptyStrokes)
+    ++emptyStrokes;
+  towerEmpty = emptyStrokes >= MaxEmptyStrokes;
+
+  // double the back-off each empty stroke, starting at the min and capped at the max
+  if (!emptyBackoff_ms)
+    emptyBackoff_ms = MinEmptyBackoff_ms;
+  else if (emptyBackoff_ms < MaxEmptyBackoff_ms / 2)
+    emptyBackoff_ms *= 2;
+  else
+    emptyBackoff_ms = MaxEmptyBackoff_ms;
+
+  // show the tower state before going idle
+  UpdateDisplay();
+
+  // idle until the back-off has elapsed or operation is stopped
+  idleTicks = emptyBackoff_ms / PIT0Interval_ms;
+  while (idleTicks && IsRunning)
+    asm wai;
+}
+
 void DetermineColour(void)
 {
-  Colours colour; // declare an instance of Colours to populate with the SCI0 read
+  unsigned char colour; // the colour byte read from SCI0 (an enum may be wider than the byte read)
 
   // send start signal 'a' (for analyse) with SCI0
   SCI0_TxByte_Block('a');
@@ -271,6 +367,106 @@ void DetermineColour(void)
   if (!IsRunning)
     return;
 
+  // display the identified colour and update the chip count
+  UpdateColour((Colours)colour);
+}
+
+// Requests the vision service's histogram reply and decides the colour on the board
+// a chip the vision service could not call clearly (low margin) is sorted as Other
+void DetermineColourHistogram(void)
+{
+  unsigned char reply[CHIPCOLOUR_HISTOGRAM_BYTES];
+  ChipColour_Histogram histogram;
+  unsigned char i;
+
+  // send start signal 'h' (for histogram) with SCI0
+  SCI0_TxByte_Block('h');
+
+  // read the fixed size reply a byte at a time, giving up if operation is stopped
+  for (i = 0; i < CHIPCOLOUR_HISTOGRAM_BYTES; ++i)
+  {
+    while (SCI0_Read(reply + i) && IsRunning)
+      ;
+    if (!IsRunning)
+      return;
+  }
+
+  // an unexpected colour byte stops running, as it does for the single byte reply
+  if (ChipColour_DecodeHistogram(reply, &histogram))
+  {
+    UpdateColour((Colours)reply[0]);
+    return;
+  }
+
+  if (histogram.margin < MinVisionMargin)
+    UpdateColour(Colour_Other);
+  else
+    UpdateColour((Colours)histogram.code);
+}
+
+// Sets up the colour sensor with blocking calls, then hands the bus to the transaction queue
+// returns 0 on success, -1 if the sensor did not respond
+int InitColourSensor(void)
+{
+  char buffer[41] = {0};
+
+  I2C_Init0(I2CMicro20MHz, I2CBus400, 0);
+  if (TCS34725_Init(SensorIntTime, SensorGain))
+    return -1;
+  PIT_Sleep_us(PIT_Channel_1, GlobalBusRate, TCS34725_WARMUP_US);
+  if (TCS34725_Enable())
+    return -1;
+  I2C_Init0(I2CMicro20MHz, I2CBus400, 1);
+
+  ChipColour_SetWhite(&SensorWhite);
+  if (SensorStream)
+  {
+    (void)sprintf(buffer, "W,%u,%u,%u,%u\r\n", SensorWhite.clear, SensorWhite.red, SensorWhite.green, SensorWhite.blue);
+    SCI0_TxStr(buffer);
+  }
+  return 0;
+}
+
+// Reads the chip in the slot with the colour sensor and classifies it on the board
+// a failed read sorts the chip as Other rather than guessing
+void SenseColour(void)
+{
+  ChipColour_Reading reading;
+  Colours colour;
+  char buffer[41] = {0};
+  unsigned int waited_us = 0;
+
+  // the sensor integrates continuously - wait for an integration taken with the chip at rest
+  PIT_Sleep_ms(PIT_Channel_1, GlobalBusRate, SensorSettle_ms);
+
+  // queue the read and wait for the IIC0 ISR to complete it
+  // a read that timed out last chip may still be pending - it is rejected here rather than redirected,
+  //  and sensorRaw is only reused once that read has finished
+  if (TCS34725_StartRead(sensorRaw))
+  {
+    UpdateColour(Colour_Other);
+    return;
+  }
+  while (TCS34725_ReadStatus() == 1 && waited_us < SensorReadTimeout_us)
+  {
+    PIT_Sleep_us(PIT_Channel_1, GlobalBusRate, 50);
+    waited_us += 50;
+  }
+  if (TCS34725_ReadStatus() || TCS34725_Unpack(sensorRaw, &reading.clear, &reading.red, &reading.green, &reading.blue))
+  {
+    UpdateColour(Colour_Other);
+    return;
+  }
+
+  colour = (Colours)ChipColour_Code(ChipColour_ClassifyReading(&reading));
+
+  // stream the reading and verdict so a run can be replayed on a PC
+  if (SensorStream)
+  {
+    (void)sprintf(buffer, "C,%u,%u,%u,%u,%c\r\n", reading.clear, reading.red, reading.green, reading.blue, (char)colour);
+    SCI0_TxStr(buffer);
+  }
+
   // display the identified colour and update the chip count
   UpdateColour(colour);
 }
@@ -332,6 +528,20 @@ interrupt VectorNumber_Vpit0 void PIT0Int(void)
   PITTF = PITTF_PTF0_MASK; // clear the flag
   if (lockout)
     --lockout;
+  if (idleTicks)
+    --idleTicks;
+}
+
+interrupt VectorNumber_Vatd0 void INT_AD0(void)
+{
+  // capture the conversion sequence into the sample buffers (reading the results clears the interrupt flag)
+  AtoD_Capture();
+}
+
+interrupt VectorNumber_Viic0 void ISR_IIC0(void)
+{
+  // advance the queued I2C transaction (colour sensor reads)
+  I2C_Service();
 }
 
 interrupt VectorNumber_Vportj void IntJ(void)
@@ -348,8 +558,9 @@ interrupt VectorNumber_Vportj void IntJ(void)
       needDisplayUpdate = 1;
       
       // toggle the operation mode and set the operating state to isolate (first state)
+      // after a failed grip, resume at pickup - the chip is still in the slot and already counted
       IsRunning ^= 1;
-      opState = State_Isolate;
+      opState = gripFailed ? State_Pickup : State_Isolate;
     }
   }
 
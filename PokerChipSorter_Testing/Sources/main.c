@@ -18,10 +18,13 @@
 #include "swled.h"      /* switches and LEDs */
 #include "timer.h"      /* timer library */
 #include "pulse.h"      /* PWM Library */
+#include "i2c.h"        /* I2C library */
+#include "LSM303.h"     /* accelerometer library */
+#include "MotionTune.h" /* motion profile tuning */
 
 // other system includes or your includes go here
 // #include <stdlib.h>
-// #include <stdio.h>
+#include <stdio.h>
 
 /////////////////////////////////////////////////////////////////////////////
 // Enumerations
@@ -32,7 +35,8 @@ typedef enum SelectedTest
   Test_Instructions,
   Test_ChipIsolator,
   Test_ColourIdentification,
-  Test_ChipSorting
+  Test_ChipSorting,
+  Test_MotionTuning
 } SelectedTest;
 
 typedef enum SortingTestColour
@@ -67,6 +71,9 @@ void ChipIsolatorTest(void);
 void ColourIdentificationTest(void);
 void UpdateColour(Colours colour);
 void ChipSortingTest(SortingTestColour currentSortingColour);
+void MotionTuningTest(void);
+void SampleSettle(void);
+void StreamSettleSamples(void);
 
 /////////////////////////////////////////////////////////////////////////////
 // Global Variables
@@ -78,9 +85,12 @@ volatile unsigned int buttonLockout = 0; // the lockout for switch debouncing
 // Constants
 /////////////////////////////////////////////////////////////////////////////
 
-const unsigned long GlobalBusRate = 20E6; // the board bus rate
-const unsigned int MinServoDuty = 350;    // min servo duty cycle for lowest servo position
-const unsigned int MaxServoDuty = 1250;   // max servo duty cycle for furthest servo position
+const unsigned long GlobalBusRate = 20E6;     // the board bus rate
+const unsigned int MinServoDuty = 350;        // min servo duty cycle for lowest servo position
+const unsigned int MaxServoDuty = 1250;       // max servo duty cycle for furthest servo position
+const int TuneMoveSteps = 200;                // motor steps for each motion tuning test move (and back)
+const int TuneTolerance = 40;                 // accelerometer counts (~1mg each) that count as settled
+const unsigned int TuneMaxSettleSamples = 40; // samples (2.5ms each) allowed before settling
 
 /////////////////////////////////////////////////////////////////////////////
 // Main Entry
@@ -106,6 +116,7 @@ void main(void)
   SWLInit();
   LCD_Init();
   Segs_Init();
+  Cap_PortAInit();
   PIT_Init(PIT_Channel_0, PIT_Interrupt_On, GlobalBusRate, 10000); // PIT0 @ 10ms intervals, interrupts on
   SCI0_Init(GlobalBusRate, BaudRate_9600, SCI_RDRF_InterruptOff);  // SCI0 @ 9600 baud
   Pulse_Init_16Bit(Pulse_Channel5, Pulse_PrescaleStage1_1, 20, Pulse_PolatityPositive, 10000, MaxServoDuty);
@@ -144,14 +155,14 @@ void main(void)
       {
         // decrement currentTest, wrapping at start, then update the display
         if (--currentTest < Test_Instructions)
-          currentTest = Test_ChipSorting;
+          currentTest = Test_MotionTuning;
         UpdateTestDisplay(currentTest);
       }
       // increment selected test if Right is pressed
       else if (SWLPressed(SWLRight))
       {
         // increment currentTest, wrapping at end, then update the display
-        if (++currentTest > Test_ChipSorting)
+        if (++currentTest > Test_MotionTuning)
           currentTest = Test_Instructions;
         UpdateTestDisplay(currentTest);
       }
@@ -206,6 +217,12 @@ void UpdateTestDisplay(SelectedTest currentTest)
     LCD_StringXY(0, 2, "Up/Down swaps colour");
     LCD_StringXY(0, 3, "Press middle to move");
     break;
+  case Test_MotionTuning:
+    LCD_StringXY(0, 0, " Motion Tuning Test ");
+    LCD_StringXY(0, 1, "Clear the arm's path");
+    LCD_StringXY(0, 2, "Middle runs moves at");
+    LCD_StringXY(0, 3, "rising speeds       ");
+    break;
   }
 }
 
@@ -252,6 +269,9 @@ void PerformTest(SelectedTest currentTest, SortingTestColour currentSortingColou
   case Test_ChipSorting:
     ChipSortingTest(currentSortingColour);
     break;
+  case Test_MotionTuning:
+    MotionTuningTest();
+    break;
   }
 }
 
@@ -345,6 +365,115 @@ void ChipSortingTest(SortingTestColour currentSortingColour)
   // return effector to start
 }
 
+// performs the motion tuning test
+// runs a test move with each candidate motion profile from gentlest to most aggressive, sampling the
+// effector's accelerometer after each move, and keeps the most aggressive profile that settles in time
+// samples and results are streamed over SCI0 (M/S/R/P lines) so a run can be recorded and replayed on a PC
+void MotionTuningTest(void)
+{
+  char buffer[41] = {0};
+  unsigned char profileIndex = 0;
+  unsigned char keepSearching = 1;
+  Tune_Profile profile;
+  int selected;
+
+  // accelerometer to its fastest rate with blocking calls, then hand the bus to the transaction queue
+  I2C_Init0(I2CMicro20MHz, I2CBus400, 0);
+  if (LSM303_Init() || LSM303_SetAccRate(LSM303_AccRate_400Hz))
+  {
+    LCD_StringXY(0, 3, "No accelerometer    ");
+    return;
+  }
+  I2C_Init0(I2CMicro20MHz, I2CBus400, 1);
+
+  Tune_StartSearch();
+  while (keepSearching)
+  {
+    unsigned int settleSamples;
+
+    profile = Tune_GetProfile(profileIndex);
+    Cap_SetMotionProfile(profile.startPeriod_us, profile.cruisePeriod_us, profile.rampStep_us);
+
+    (void)sprintf(buffer, "Profile %2u of %2u    ", profileIndex + 1, Tune_ProfileCount());
+    LCD_StringXY(0, 3, buffer);
+    (void)sprintf(buffer, "M,%u,%u,%u,%u\r\n", profileIndex, profile.startPeriod_us, profile.cruisePeriod_us, profile.rampStep_us);
+    SCI0_TxStr(buffer);
+
+    // test move out, then sample the residual vibration once the motors have stopped
+    Cap_MoveEffector(TuneMoveSteps, TuneMoveSteps, TuneMoveSteps);
+    SampleSettle();
+
+    settleSamples = Tune_SettleSamples(TuneTolerance);
+    keepSearching = Tune_RecordResult(settleSamples, TuneMaxSettleSamples);
+
+    // stream after sampling so the serial link can't hold up the sample timing
+    StreamSettleSamples();
+    (void)sprintf(buffer, "R,%u,%u,%u\r\n", profileIndex, settleSamples, settleSamples <= TuneMaxSettleSamples);
+    SCI0_TxStr(buffer);
+
+    // move back to the start and let the arm come to rest before the next profile
+    Cap_MoveEffector(0, 0, 0);
+    PIT_Sleep_ms(PIT_Channel_1, GlobalBusRate, 500);
+    ++profileIndex;
+  }
+
+  selected = Tune_SelectedProfile();
+  (void)sprintf(buffer, "P,%d\r\n", selected);
+  SCI0_TxStr(buffer);
+
+  // nothing settled - fall back to the gentlest profile
+  if (selected < 0)
+  {
+    profile = Tune_GetProfile(0);
+    LCD_StringXY(0, 3, "No profile settled  ");
+  }
+  else
+  {
+    profile = Tune_GetProfile((unsigned char)selected);
+    (void)sprintf(buffer, "Cruise%5u Ramp%3u ", profile.cruisePeriod_us, profile.rampStep_us);
+    LCD_StringXY(0, 3, buffer);
+  }
+  Cap_SetMotionProfile(profile.startPeriod_us, profile.cruisePeriod_us, profile.rampStep_us);
+}
+
+// fills the tuning window with accelerometer samples, one every 2.5ms (400Hz data rate)
+void SampleSettle(void)
+{
+  unsigned char xyz[6]; // XH XL YH YL ZH ZL
+  unsigned int i;
+
+  Tune_Reset();
+  for (i = 0; i < TUNE_MAX_SAMPLES; ++i)
+  {
+    // queue the read, then wait out the sample period while it completes in the background
+    if (LSM303_StartXYZ(xyz))
+      return;
+    PIT_Sleep_us(PIT_Channel_1, GlobalBusRate, 2500);
+    if (LSM303_XYZStatus())
+      return; // not done within a sample period - bus trouble, analyse what was collected
+
+    // 12-bit left-justified two's complement readings
+    (void)Tune_AddSample(
+        (int)(((unsigned int)xyz[0] << 8) | xyz[1]) >> 4,
+        (int)(((unsigned int)xyz[2] << 8) | xyz[3]) >> 4,
+        (int)(((unsigned int)xyz[4] << 8) | xyz[5]) >> 4);
+  }
+}
+
+// sends every sample in the tuning window over SCI0 as S,x,y,z lines
+void StreamSettleSamples(void)
+{
+  char buffer[41] = {0};
+  int x, y, z;
+  unsigned int i;
+
+  for (i = 0; !Tune_GetSample(i, &x, &y, &z); ++i)
+  {
+    (void)sprintf(buffer, "S,%d,%d,%d\r\n", x, y, z);
+    SCI0_TxStr(buffer);
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Interrupt Service Routines
 /////////////////////////////////////////////////////////////////////////////
@@ -356,4 +485,10 @@ interrupt VectorNumber_Vpit0 void PIT0Int(void)
   // decrement the lockout until cleared
   if (buttonLockout)
     --buttonLockout;
+}
+
+interrupt VectorNumber_Viic0 void ISR_IIC0(void)
+{
+  // advance the queued I2C transaction (accelerometer reads during motion tuning)
+  I2C_Service();
 }
\ No newline at end of file
@@ -9,6 +9,10 @@
 //      March 20, 2023 - Created lib and PortA enum masks
 //      March 21, 2023 - Implemented PortA management functions
 //      March 23, 2023 - Implemented motor movement functions - untested
+//      Oct. 19, 2026  - Added vacuum sensor grip/release detection for the pump
+//      Oct. 19, 2026  - Added isolator slot chip presence sensing
+//      Oct. 19, 2026  - Vacuum and presence sensors use the filtered AtoD average
+//      Oct. 19, 2026  - Added acceleration/cruise step timing profile to effector moves
 /////////////////////////////////////////////////////////////////////////////
 
 #include <hidef.h>      /* common defines and macros */
@@ -17,6 +21,7 @@
 
 #include "capstone.h"
 #include "pit.h"
+#include "atod.h"
 
 // other includes, as *required* for this implementation
 
@@ -24,7 +29,10 @@
 // local prototypes
 /////////////////////////////////////////////////////////////////////////////
 void Cap_MotorStep(unsigned char mask);
+void Cap_StepGap(unsigned int stepIndex, unsigned int moveSteps);
+unsigned int Cap_StepDistance(int currentStep, int targetStep);
 void Cap_SetMotorDirection(unsigned char motorDirectionMask, int currentStep, int targetStep);
+int Cap_WaitForVacuum(unsigned char waitForGrip, unsigned int timeout_ms);
 
 // inverse kinematics functions translated from JavaScript (source : https://www.marginallyclever.com/other/samples/fk-ik-test.html)
 
@@ -37,6 +45,12 @@ int Cap_AngleToStep(float theta);
 // library variables
 /////////////////////////////////////////////////////////////////////////////
 
+// step timing for Cap_MoveEffector, set with Cap_SetMotionProfile
+// defaults step back to back (no gap after the pulse) with no ramp
+unsigned int MotionStartPeriod_us = 100;
+unsigned int MotionCruisePeriod_us = 100;
+unsigned int MotionRampStep_us = 0;
+
 /////////////////////////////////////////////////////////////////////////////
 // constants
 /////////////////////////////////////////////////////////////////////////////
@@ -51,6 +65,19 @@ const float BaseToFloor = 200;
 // number of motor steps per revolution
 const unsigned int StepsPerRev = 3200;
 
+// width of each step pulse (us), also the shortest possible step period
+const unsigned int StepPulse_us = 100;
+
+// vacuum sensor on the suction cup line (10-bit AtoD counts, tune to the sensor and cup)
+// the gap between the thresholds gives hysteresis so a noisy reading can't confirm both states
+const AtoD_Channels VacuumSensorChannel = AtoD_Channel0;
+const unsigned int VacuumGripThreshold = 600;    // at or above = cup sealed on a chip
+const unsigned int VacuumReleaseThreshold = 300; // at or below = vacuum dropped, chip released
+
+// IR reflective sensor looking into the isolator slot (10-bit AtoD counts)
+const AtoD_Channels ChipSensorChannel = AtoD_Channel1;
+const unsigned int ChipPresentThreshold = 512; // at or above = chip face reflecting into the sensor
+
 /////////////////////////////////////////////////////////////////////////////
 // function implementations
 /////////////////////////////////////////////////////////////////////////////
@@ -94,6 +121,15 @@ void Cap_MoveEffector(int m1TargetStep, int m2TargetStep, int m3TargetStep)
     static int m2CurrentStep = 0;
     static int m3CurrentStep = 0;
     unsigned char motorsToMove = 0;
+    unsigned int stepIndex = 0;
+    unsigned int moveSteps;
+
+    // all motors step together, so the move takes as many steps as the furthest motor has to go
+    moveSteps = Cap_StepDistance(m1CurrentStep, m1TargetStep);
+    if (Cap_StepDistance(m2CurrentStep, m2TargetStep) > moveSteps)
+        moveSteps = Cap_StepDistance(m2CurrentStep, m2TargetStep);
+    if (Cap_StepDistance(m3CurrentStep, m3TargetStep) > moveSteps)
+        moveSteps = Cap_StepDistance(m3CurrentStep, m3TargetStep);
 
     // setup the direction bits for all the motors before starting to step
     Cap_SetMotorDirection(Motor1Direction, m1CurrentStep, m1TargetStep);
@@ -129,15 +165,57 @@ void Cap_MoveEffector(int m1TargetStep, int m2TargetStep, int m3TargetStep)
             m3CurrentStep = Cap_PortARead(Motor3Direction) ? m3CurrentStep - 1 : m3CurrentStep + 1;//dir high = decrease step
         }
 
-        // if there are motors to move, step them
+        // if there are motors to move, step them, then wait out the rest of the step period
         if (motorsToMove)
+        {
             Cap_MotorStep(motorsToMove);
+            Cap_StepGap(stepIndex++, moveSteps);
+        }
     } while (motorsToMove);
 
     // disable the motors
     Cap_PortASet(MotorDisable);
 }
 
+// Sets the step timing used by Cap_MoveEffector
+// startPeriod_us is the period at the ends of a move, cruisePeriod_us the shortest period once accelerated,
+// and rampStep_us how much the period changes each step while accelerating/decelerating
+void Cap_SetMotionProfile(unsigned int startPeriod_us, unsigned int cruisePeriod_us, unsigned int rampStep_us)
+{
+    // can't step faster than the pulse itself, and the ends of the move can't be faster than cruise
+    if (cruisePeriod_us < StepPulse_us)
+        cruisePeriod_us = StepPulse_us;
+    if (startPeriod_us < cruisePeriod_us)
+        startPeriod_us = cruisePeriod_us;
+
+    MotionStartPeriod_us = startPeriod_us;
+    MotionCruisePeriod_us = cruisePeriod_us;
+    MotionRampStep_us = rampStep_us;
+}
+
+// Turns the pump on and waits for the vacuum sensor to confirm the chip is held
+// returns 0 once the grip is confirmed, -1 if the timeout elapsed first (pump is left on)
+int Cap_PumpGrip(unsigned int timeout_ms)
+{
+    Cap_PortASet(PumpControl);
+    return Cap_WaitForVacuum(1, timeout_ms);
+}
+
+// Turns the pump off and waits for the vacuum sensor to show the chip has been released
+// returns 0 once the vacuum has dropped, -1 if the timeout elapsed first
+int Cap_PumpRelease(unsigned int timeout_ms)
+{
+    Cap_PortAClear(PumpControl);
+    return Cap_WaitForVacuum(0, timeout_ms);
+}
+
+// Checks the slot's presence sensor for an isolated chip
+// returns 1 if a chip is in the slot, 0 if the slot is empty
+unsigned char Cap_ChipPresent(void)
+{
+    return AtoD_ReadAverage(ChipSensorChannel) >= ChipPresentThreshold;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Hidden Helpers (local to implementation only)
 /////////////////////////////////////////////////////////////////////////////
@@ -148,10 +226,36 @@ void Cap_MotorStep(unsigned char mask)
     // set the mask bits, sleep for 100us, then clear the mask bits
     // the mask contains the StepPulse bits of all motors to be steped
     Cap_PortASet(mask);
-    PIT_Sleep_us(PIT_Channel_1, 20E6, 100);
+    PIT_Sleep_us(PIT_Channel_1, 20E6, StepPulse_us);
     Cap_PortAClear(mask);
 }
 
+// Sleeps for the rest of the step period after a step pulse, following the motion profile
+// the period ramps down from the start period by the ramp step each step until it reaches cruise,
+// and ramps back up symmetrically over the end of the move
+void Cap_StepGap(unsigned int stepIndex, unsigned int moveSteps)
+{
+    unsigned int period_us = MotionCruisePeriod_us;
+
+    // steps from the nearest end of the move
+    unsigned int rampSteps = moveSteps - 1 - stepIndex;
+    if (stepIndex < rampSteps)
+        rampSteps = stepIndex;
+
+    // still ramping if the period hasn't come down to cruise yet
+    if ((unsigned long)rampSteps * MotionRampStep_us < MotionStartPeriod_us - MotionCruisePeriod_us)
+        period_us = MotionStartPeriod_us - rampSteps * MotionRampStep_us;
+
+    if (period_us > StepPulse_us)
+        PIT_Sleep_us(PIT_Channel_1, 20E6, period_us - StepPulse_us);
+}
+
+// Returns the number of steps between the current and target step
+unsigned int Cap_StepDistance(int currentStep, int targetStep)
+{
+    return currentStep < targetStep ? targetStep - currentStep : currentStep - targetStep;
+}
+
 // Sets or clears the motor's direction bit based on if the motor's current step is above or below the target step
 // Bit does not change if currentStep = targetStep
 void Cap_SetMotorDirection(unsigned char motorDirectionMask, int currentStep, int targetStep)
@@ -166,6 +270,28 @@ void Cap_SetMotorDirection(unsigned char motorDirectionMask, int currentStep, in
         Cap_PortASet(motorDirectionMask);//dir high = decrease step
 }
 
+// Polls the vacuum sensor every 1ms until it crosses the grip threshold (waitForGrip = 1)
+// or the release threshold (waitForGrip = 0)
+// returns 0 as soon as the threshold is crossed, -1 if timeout_ms elapses first
+int Cap_WaitForVacuum(unsigned char waitForGrip, unsigned int timeout_ms)
+{
+    unsigned int elapsed_ms = 0;
+
+    for (;;)
+    {
+        unsigned int vacuum = AtoD_ReadAverage(VacuumSensorChannel);
+
+        if (waitForGrip ? vacuum >= VacuumGripThreshold : vacuum <= VacuumReleaseThreshold)
+            return 0;
+
+        // timeout_ms polls in all, so no sleep follows the last one
+        if (++elapsed_ms >= timeout_ms)
+            return -1;
+
+        PIT_Sleep_ms(PIT_Channel_1, 20E6, 1);
+    }
+}
+
 // inverse kinematics functions translated from JavaScript (source : https://www.marginallyclever.com/other/samples/fk-ik-test.html)
 
 double sqrt3, pi, sin120, cos120, tan60, sin30, tan30;
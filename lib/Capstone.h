@@ -33,6 +33,24 @@ void Cap_PortAToggle(unsigned char mask);
 
 void Cap_MoveEffector(int m1TargetStep, int m2TargetStep, int m3TargetStep);
 
+// sets the step timing used by Cap_MoveEffector (all motors step together at this rate)
+// startPeriod_us  : step period at the start and end of a move (slowest)
+// cruisePeriod_us : shortest step period, reached once accelerated (min 100us, the step pulse width)
+// rampStep_us     : period change per step while accelerating/decelerating (0 = whole move at startPeriod_us)
+void Cap_SetMotionProfile(unsigned int startPeriod_us, unsigned int cruisePeriod_us, unsigned int rampStep_us);
+
+// turns the pump on and waits for the vacuum sensor to confirm the chip is held
+// returns 0 once the grip is confirmed, -1 if the timeout elapsed first (pump is left on)
+int Cap_PumpGrip(unsigned int timeout_ms);
+
+// turns the pump off and waits for the vacuum sensor to show the chip has been released
+// returns 0 once the vacuum has dropped, -1 if the timeout elapsed first
+int Cap_PumpRelease(unsigned int timeout_ms);
+
+// checks the slot's presence sensor for an isolated chip
+// returns 1 if a chip is in the slot, 0 if the slot is empty
+unsigned char Cap_ChipPresent(void);
+
 /////////////////////////////////////////////////////////////////////////////
 // Hidden Helpers (local to implementation only)
 /////////////////////////////////////////////////////////////////////////////
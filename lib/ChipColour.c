@@ -0,0 +1,221 @@
+/////////////////////////////////////////////////////////////////////////////
+// Processor:     MC9S12XDP512 (also builds on a PC, no hardware access)
+// Bus Speed:     20 MHz (Requires Active PLL)
+// Author:        Andrew Belter
+// Created:       Oct. 19, 2026
+// Details:       On-board chip colour classification from a colour sensor reading.
+//                No hidef/derivative includes so the file can be built on a PC.
+// Revision History
+//      each revision will have a date + desc. of changes
+//      Oct. 19, 2026 - Created HSV conversion and classification
+//      Oct. 19, 2026 - Added histogram reply decoding
+/////////////////////////////////////////////////////////////////////////////
+
+#include "ChipColour.h"
+
+// other includes, as *required* for this implementation
+
+/////////////////////////////////////////////////////////////////////////////
+// local prototypes
+/////////////////////////////////////////////////////////////////////////////
+unsigned char ChipColour_Balance(unsigned int raw, unsigned int white);
+int ChipColour_FixedRound(long value);
+
+/////////////////////////////////////////////////////////////////////////////
+// library variables
+/////////////////////////////////////////////////////////////////////////////
+ChipColour_Reading ChipColourWhite = {255, 255, 255, 255}; // white reference, reads as raw counts until set
+
+/////////////////////////////////////////////////////////////////////////////
+// constants
+/////////////////////////////////////////////////////////////////////////////
+
+// hue range (OpenCV 8-bit hue, low/high inclusive) for a colourful category
+typedef struct ChipColour_Range
+{
+    unsigned char low;
+    unsigned char high;
+    ChipColour_Category category;
+} ChipColour_Range;
+
+// same ranges, in the same order, as colour_ranges in colour_detection.py - the first matching range wins
+const ChipColour_Range ChipColourRanges[] = {
+    {0, 20, ChipColour_Red},
+    {21, 25, ChipColour_Orange},
+    {26, 34, ChipColour_Yellow},
+    {35, 89, ChipColour_Green},
+    {90, 135, ChipColour_Blue},
+    {136, 150, ChipColour_Purple},
+    {151, 164, ChipColour_Pink},
+    {165, 179, ChipColour_Red}};
+
+// saturation above this is colourful (categorized by hue), otherwise dull (categorized by value)
+const unsigned char ChipColourSaturationThreshold = 255 / 2;
+// value above this is a white dull reading, otherwise black
+const unsigned char ChipColourValueThreshold = 255 / 2;
+
+// OpenCV's fixed point shift for the 8-bit HSV conversion
+const int ChipColourHsvShift = 12;
+
+const char *const ChipColourNames[] = {"white", "black", "red", "orange", "yellow", "green", "blue", "purple", "pink", "none"};
+
+/////////////////////////////////////////////////////////////////////////////
+// function implementations
+/////////////////////////////////////////////////////////////////////////////
+
+// set the white reference (a reading of a white chip in the slot)
+void ChipColour_SetWhite(ChipColour_Reading const *pWhite)
+{
+    if (pWhite->clear)
+        ChipColourWhite.clear = pWhite->clear;
+    if (pWhite->red)
+        ChipColourWhite.red = pWhite->red;
+    if (pWhite->green)
+        ChipColourWhite.green = pWhite->green;
+    if (pWhite->blue)
+        ChipColourWhite.blue = pWhite->blue;
+}
+
+// white balance a reading to 8-bit RGB and convert it to HSV, as cv2.COLOR_BGR2HSV does
+ChipColour_HSV ChipColour_ToHSV(ChipColour_Reading const *pReading)
+{
+    ChipColour_HSV hsv = {0, 0, 0};
+    int r = ChipColour_Balance(pReading->red, ChipColourWhite.red);
+    int g = ChipColour_Balance(pReading->green, ChipColourWhite.green);
+    int b = ChipColour_Balance(pReading->blue, ChipColourWhite.blue);
+    int v = r;
+    int vmin = r;
+    int diff;
+    int h;
+
+    if (g > v)
+        v = g;
+    if (b > v)
+        v = b;
+    if (g < vmin)
+        vmin = g;
+    if (b < vmin)
+        vmin = b;
+    diff = v - vmin;
+
+    hsv.val = (unsigned char)v;
+    if (!diff)
+        return hsv; // grey - OpenCV gives hue and saturation 0
+
+    // OpenCV rounds its division tables to (255 << shift) / v and (180 << shift) / (6 * diff)
+    hsv.sat = (unsigned char)ChipColour_FixedRound((long)diff * ((((255L << ChipColourHsvShift) * 2) / v + 1) / 2));
+
+    if (v == r)
+        h = g - b;
+    else if (v == g)
+        h = b - r + 2 * diff;
+    else
+        h = r - g + 4 * diff;
+    h = ChipColour_FixedRound((long)h * ((((30L << ChipColourHsvShift) * 2) / diff + 1) / 2));
+    if (h < 0)
+        h += 180;
+    hsv.hue = (unsigned char)h;
+
+    return hsv;
+}
+
+// categorize an HSV value, as pixel_categories does for a pixel
+ChipColour_Category ChipColour_Classify(ChipColour_HSV hsv)
+{
+    unsigned char i;
+
+    if (hsv.sat <= ChipColourSaturationThreshold)
+        return hsv.val > ChipColourValueThreshold ? ChipColour_White : ChipColour_Black;
+
+    for (i = 0; i < sizeof(ChipColourRanges) / sizeof(ChipColourRanges[0]); ++i)
+    {
+        if (hsv.hue >= ChipColourRanges[i].low && hsv.hue <= ChipColourRanges[i].high)
+            return ChipColourRanges[i].category;
+    }
+    return ChipColour_None;
+}
+
+// white balance, convert and categorize a reading
+ChipColour_Category ChipColour_ClassifyReading(ChipColour_Reading const *pReading)
+{
+    return ChipColour_Classify(ChipColour_ToHSV(pReading));
+}
+
+// the colour byte the vision service replies with for the category
+unsigned char ChipColour_Code(ChipColour_Category category)
+{
+    switch (category)
+    {
+    case ChipColour_Red:
+        return 'r';
+    case ChipColour_Green:
+        return 'g';
+    case ChipColour_Blue:
+        return 'b';
+    case ChipColour_White:
+        return 'w';
+    case ChipColour_Black:
+        return 'k';
+    default:
+        return 'o';
+    }
+}
+
+// the category name, as used by the vision service
+char const *ChipColour_Name(ChipColour_Category category)
+{
+    if (category > ChipColour_None)
+        category = ChipColour_None;
+    return ChipColourNames[category];
+}
+
+// decode a histogram reply (CHIPCOLOUR_HISTOGRAM_BYTES long)
+int ChipColour_DecodeHistogram(unsigned char const *pReply, ChipColour_Histogram *pHistogram)
+{
+    unsigned char i;
+
+    switch (pReply[0])
+    {
+    case 'r':
+    case 'g':
+    case 'b':
+    case 'w':
+    case 'k':
+    case 'o':
+        break;
+    default:
+        return -1;
+    }
+
+    pHistogram->code = pReply[0];
+    pHistogram->margin = pReply[1];
+    pHistogram->top = ChipColour_White;
+    for (i = 0; i < ChipColour_None; ++i)
+    {
+        pHistogram->shares[i] = pReply[2 + i];
+        if (pHistogram->shares[i] > pHistogram->shares[pHistogram->top])
+            pHistogram->top = (ChipColour_Category)i;
+    }
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Hidden Helpers (local to implementation only)
+/////////////////////////////////////////////////////////////////////////////
+
+// scales a raw count so the white reference reads 255, clamped to 255
+unsigned char ChipColour_Balance(unsigned int raw, unsigned int white)
+{
+    if (raw >= white)
+        return 255;
+    return (unsigned char)(((unsigned long)raw * 255 + white / 2) / white);
+}
+
+// rounds a fixed point value to an integer (adds a half and floors, as OpenCV's arithmetic shift does)
+int ChipColour_FixedRound(long value)
+{
+    value += 1L << (ChipColourHsvShift - 1);
+    if (value >= 0)
+        return (int)(value >> ChipColourHsvShift);
+    return (int)-((-value + (1L << ChipColourHsvShift) - 1) >> ChipColourHsvShift);
+}
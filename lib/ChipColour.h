@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////
+// Processor:     MC9S12XDP512 (also builds on a PC, no hardware access)
+// Bus Speed:     20 MHz (Requires Active PLL)
+// Author:        Andrew Belter
+// Created:       Oct. 19, 2026
+// Details:       On-board chip colour classification from a colour sensor reading.
+//                A reading is white balanced, converted to OpenCV's 8-bit HSV and
+//                categorized with the same hue ranges and saturation/value thresholds
+//                as the PC vision service (ColourDetection/colour_detection.py), so the
+//                board can decide a chip's colour without the PC. No hardware access,
+//                so recorded readings can be replayed on a PC.
+//                Also decodes the vision service's histogram reply, so the board can
+//                apply its own policy to the PC's decision.
+/////////////////////////////////////////////////////////////////////////////
+
+// bytes in the vision service's histogram reply ('h' request, see HISTOGRAM_CATEGORIES in sorter.py)
+// colour byte, margin, then the share of each category in ChipColour_Category order (all 0-255)
+#define CHIPCOLOUR_HISTOGRAM_BYTES 11
+
+/////////////////////////////////////////////////////////////////////////////
+// Enumerations
+/////////////////////////////////////////////////////////////////////////////
+
+// colour categories, in the vision service's CATEGORIES order
+typedef enum ChipColour_Category
+{
+    ChipColour_White,
+    ChipColour_Black,
+    ChipColour_Red,
+    ChipColour_Orange,
+    ChipColour_Yellow,
+    ChipColour_Green,
+    ChipColour_Blue,
+    ChipColour_Purple,
+    ChipColour_Pink,
+    ChipColour_None // hue outside every range (not reported)
+} ChipColour_Category;
+
+/////////////////////////////////////////////////////////////////////////////
+// Types
+/////////////////////////////////////////////////////////////////////////////
+
+// raw channel counts from the sensor
+typedef struct ChipColour_Reading
+{
+    unsigned int clear;
+    unsigned int red;
+    unsigned int green;
+    unsigned int blue;
+} ChipColour_Reading;
+
+// OpenCV 8-bit HSV - hue 0-179, saturation and value 0-255
+typedef struct ChipColour_HSV
+{
+    unsigned char hue;
+    unsigned char sat;
+    unsigned char val;
+} ChipColour_HSV;
+
+// a decoded histogram reply - shares and margin are quantised, 255 being every sample
+typedef struct ChipColour_Histogram
+{
+    unsigned char code;                    // the vision service's colour byte
+    ChipColour_Category top;               // category with the largest share (first on ties)
+    unsigned char margin;                  // top share minus the runner up's, over all samples
+    unsigned char shares[ChipColour_None]; // share per category, indexed by ChipColour_Category
+} ChipColour_Histogram;
+
+/////////////////////////////////////////////////////////////////////////////
+// Library Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+// set the white reference (a reading of a white chip in the slot)
+// each channel is scaled so the reference reads 255, channels of 0 are ignored
+void ChipColour_SetWhite(ChipColour_Reading const *pWhite);
+
+// white balance a reading to 8-bit RGB and convert it to HSV, as cv2.COLOR_BGR2HSV does
+ChipColour_HSV ChipColour_ToHSV(ChipColour_Reading const *pReading);
+
+// categorize an HSV value, as pixel_categories does for a pixel
+// saturation above the threshold is categorized by hue (first matching range), otherwise
+// value above the threshold is white, otherwise black
+ChipColour_Category ChipColour_Classify(ChipColour_HSV hsv);
+
+// white balance, convert and categorize a reading
+ChipColour_Category ChipColour_ClassifyReading(ChipColour_Reading const *pReading);
+
+// the colour byte the vision service replies with for the category
+// r=Red, g=Green, b=Blue, w=White, k=Black, o=Other
+unsigned char ChipColour_Code(ChipColour_Category category);
+
+// the category name, as used by the vision service
+char const *ChipColour_Name(ChipColour_Category category);
+
+// decode a histogram reply (CHIPCOLOUR_HISTOGRAM_BYTES long)
+// returns 0 on success, -1 if the colour byte is not one the vision service sends
+int ChipColour_DecodeHistogram(unsigned char const *pReply, ChipColour_Histogram *pHistogram);
+
+/////////////////////////////////////////////////////////////////////////////
+// Hidden Helpers (local to implementation only)
+/////////////////////////////////////////////////////////////////////////////
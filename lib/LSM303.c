@@ -9,6 +9,8 @@
 //      each revision will have a date + desc. of changes
 //      Dec. 8 2022 - Added Init, GetAccStatus, and GetXYZ functions using code
 //                    provided by Simon Walker
+//      Oct. 19 2026 - Added queued XYZ read (StartXYZ/XYZStatus) for the I2C transaction queue
+//      Oct. 19 2026 - Added SetAccRate for faster accelerometer sampling
 /////////////////////////////////////////////////////////////////////////////
 
 
@@ -44,11 +46,15 @@ int LSM303_GetTemp (void);
 /////////////////////////////////////////////////////////////////////////////
 // library variables
 /////////////////////////////////////////////////////////////////////////////
+I2C_Transaction LSM303_XYZXfer; // queued XYZ read, reused for every LSM303_StartXYZ
 
 /////////////////////////////////////////////////////////////////////////////
 // constants
 /////////////////////////////////////////////////////////////////////////////
 
+// first XYZ register (0x28) with the MSB set for multi-byte reads
+const unsigned char LSM303_XYZRegister = 0x28 | 0x80;
+
 /////////////////////////////////////////////////////////////////////////////
 // function implementations
 /////////////////////////////////////////////////////////////////////////////
@@ -97,6 +103,21 @@ int LSM303_Init (void)
   return 0;  
 }
 
+int LSM303_SetAccRate (LSM303_AccRate rate)
+{
+  if (!I2C_SendAddressRW(LSM303_ADDR_ACC, I2C_WRITE, I2C_WAIT))
+  {
+    // register 0x20 - CTRL_REG1_A
+    (void)I2C_WriteByte (0x20, I2C_NOSTOP);
+    // requested rate, normal mode, XYZ enable
+    (void)I2C_WriteByte ((unsigned char)((rate << 4) | 0b0111), I2C_STOP);
+  }
+  else
+    return -1;
+
+  return 0;
+}
+
 unsigned char LSM303_GetMagStatus (void)
 {
   unsigned char retVal = 0;
@@ -173,6 +194,36 @@ int LSM303_GetXYZ (unsigned char * pTarget)
   }  
 }
 
+int LSM303_StartXYZ (unsigned char * pTarget)
+{
+  // the ISR is still filling the last target - leave its transaction alone
+  if (LSM303_XYZXfer.status == I2C_Status_Pending)
+    return -1;
+
+  // same sequence as LSM303_GetXYZ, write 0x28 | 0x80, restart, read 6 bytes
+  LSM303_XYZXfer.address = LSM303_ADDR_ACC;
+  LSM303_XYZXfer.pWrite = &LSM303_XYZRegister;
+  LSM303_XYZXfer.writeCount = 1;
+  LSM303_XYZXfer.pRead = pTarget;
+  LSM303_XYZXfer.readCount = 6;
+
+  return I2C_Queue(&LSM303_XYZXfer);
+}
+
+int LSM303_XYZStatus (void)
+{
+  switch (LSM303_XYZXfer.status)
+  {
+  case I2C_Status_Done:
+    return 0;
+  case I2C_Status_Pending:
+    I2C_QueueRetry(); // may be waiting for the bus
+    return 1;
+  default:
+    return -1;
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Hidden Helpers (local to implementation only)
 /////////////////////////////////////////////////////////////////////////////
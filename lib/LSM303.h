@@ -9,9 +9,22 @@
 #define LSM303_ADDR_ACC 0x32
 #define LSM303_ADDR_MAG 0x3C
 
+// accelerometer output data rates (ODR bits of CTRL_REG1_A)
+typedef enum LSM303_AccRate
+{
+  LSM303_AccRate_10Hz = 0b0010,
+  LSM303_AccRate_50Hz = 0b0100,
+  LSM303_AccRate_100Hz = 0b0101,
+  LSM303_AccRate_200Hz = 0b0110,
+  LSM303_AccRate_400Hz = 0b0111
+} LSM303_AccRate;
+
 // init simple
 int LSM303_Init (void);
 
+// change the accelerometer data rate from the 10Hz set by init (normal mode, XYZ enable)
+int LSM303_SetAccRate (LSM303_AccRate rate);
+
 // pull status register from device
 unsigned char LSM303_GetAccStatus (void);
 
@@ -22,6 +35,15 @@ unsigned char LSM303_GetMagStatus (void);
 // XH XL YH YL ZH ZL
 int LSM303_GetXYZ (unsigned char * pTarget);
 
+// queued (background) version of LSM303_GetXYZ, needs the I2C transaction queue running
+// skips the status check - with block update on, the latest complete sample is read
+// returns 0 if queued, -1 if the last queued read is still pending or the queue is full
+int LSM303_StartXYZ (unsigned char * pTarget);
+
+// state of the last LSM303_StartXYZ read
+// returns 0 when pTarget has been filled, 1 while pending, -1 on error
+int LSM303_XYZStatus (void);
+
 // appears to be an uncalibrated (relative) temp sensor
 // yank temperature from device (return -300 if error)
 int LSM303_GetTemp (void);
\ No newline at end of file
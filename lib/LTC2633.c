@@ -6,6 +6,7 @@
 // Details:       Library for using LTC2633 DAC
 // Revision History
 //      each revision will have a date + desc. of changes
+//      Oct. 19, 2026 - Added queued channel write for the I2C transaction queue
 /////////////////////////////////////////////////////////////////////////////
 
 #include <hidef.h>      /* common defines and macros */
@@ -19,10 +20,13 @@
 /////////////////////////////////////////////////////////////////////////////
 // local prototypes
 /////////////////////////////////////////////////////////////////////////////
+unsigned char LTC2633_ChanCommand(LTC2633_CHAN_SELECT chan);
 
 /////////////////////////////////////////////////////////////////////////////
 // library variables
 /////////////////////////////////////////////////////////////////////////////
+I2C_Transaction LTC2633_Xfer;        // queued write, reused for every LTC2633_QueueChan
+unsigned char LTC2633_XferBuffer[3]; // command, msb data, lsb data for the queued write
 
 /////////////////////////////////////////////////////////////////////////////
 // constants
@@ -37,12 +41,7 @@ int LTC2633_WriteChan(unsigned int Value, LTC2633_CHAN_SELECT chan)
     if (I2C_SendAddressRW(LTC2633ADDR, I2C_WRITE, I2C_WAIT))
         return -1;
     // send command (write chan, power up all)
-    if (chan == LTC2633_CHAN_A)
-        (void)I2C_WriteByte(0b00100000, I2C_NOSTOP); // P18, datasheet
-    else if (chan == LTC2633_CHAN_B)
-        (void)I2C_WriteByte(0b00100001, I2C_NOSTOP); // P18, datasheet
-    else                                             // assume all channels
-        (void)I2C_WriteByte(0b00101111, I2C_NOSTOP); // P18, datasheet
+    (void)I2C_WriteByte(LTC2633_ChanCommand(chan), I2C_NOSTOP);
 
     // send msb data (data is 12 bits, oddly, left aligned, P18, datasheet)
     (void)I2C_WriteByte((unsigned char)(Value >> 4), I2C_NOSTOP); // 0x0123 becomes 0x12
@@ -53,6 +52,51 @@ int LTC2633_WriteChan(unsigned int Value, LTC2633_CHAN_SELECT chan)
     return 0; // good condition
 }
 
+int LTC2633_QueueChan(unsigned int Value, LTC2633_CHAN_SELECT chan)
+{
+    // the buffer is still being sent while the last write is pending
+    if (LTC2633_Xfer.status == I2C_Status_Pending)
+        return -1;
+
+    // same bytes as LTC2633_WriteChan
+    LTC2633_XferBuffer[0] = LTC2633_ChanCommand(chan);
+    LTC2633_XferBuffer[1] = (unsigned char)(Value >> 4);
+    LTC2633_XferBuffer[2] = (unsigned char)(Value << 4);
+
+    LTC2633_Xfer.address = LTC2633ADDR;
+    LTC2633_Xfer.pWrite = LTC2633_XferBuffer;
+    LTC2633_Xfer.writeCount = 3;
+    LTC2633_Xfer.pRead = 0;
+    LTC2633_Xfer.readCount = 0;
+
+    return I2C_Queue(&LTC2633_Xfer);
+}
+
+int LTC2633_QueueStatus(void)
+{
+    switch (LTC2633_Xfer.status)
+    {
+    case I2C_Status_Done:
+        return 0;
+    case I2C_Status_Pending:
+        I2C_QueueRetry(); // may be waiting for the bus
+        return 1;
+    default:
+        return -1;
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Hidden Helpers (local to implementation only)
 /////////////////////////////////////////////////////////////////////////////
+
+// command byte for writing a channel (write chan, power up all)
+unsigned char LTC2633_ChanCommand(LTC2633_CHAN_SELECT chan)
+{
+    if (chan == LTC2633_CHAN_A)
+        return 0b00100000; // P18, datasheet
+    else if (chan == LTC2633_CHAN_B)
+        return 0b00100001; // P18, datasheet
+    else                   // assume all channels
+        return 0b00101111; // P18, datasheet
+}
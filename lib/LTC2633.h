@@ -38,4 +38,12 @@ typedef enum LTC2633_CHAN_SELECT
 } LTC2633_CHAN_SELECT;
 
 // write a channel
-int LTC2633_WriteChan (unsigned int Value, LTC2633_CHAN_SELECT chan);
\ No newline at end of file
+int LTC2633_WriteChan (unsigned int Value, LTC2633_CHAN_SELECT chan);
+
+// queued (background) version of LTC2633_WriteChan, needs the I2C transaction queue running
+// returns 0 if queued, -1 if the last queued write is still pending or the queue is full
+int LTC2633_QueueChan (unsigned int Value, LTC2633_CHAN_SELECT chan);
+
+// state of the last LTC2633_QueueChan write
+// returns 0 when written, 1 while pending, -1 on error
+int LTC2633_QueueStatus (void);
\ No newline at end of file
@@ -0,0 +1,191 @@
+/////////////////////////////////////////////////////////////////////////////
+// Processor:     MC9S12XDP512 (also builds on a PC, no hardware access)
+// Bus Speed:     20 MHz (Requires Active PLL)
+// Author:        Andrew Belter
+// Created:       Oct. 19, 2026
+// Details:       Residual vibration analysis for tuning the effector motion profile.
+//                No hidef/derivative includes so the file can be built on a PC.
+// Revision History
+//      each revision will have a date + desc. of changes
+//      Oct. 19, 2026 - Created settle analysis and profile search
+/////////////////////////////////////////////////////////////////////////////
+
+#include "MotionTune.h"
+
+// other includes, as *required* for this implementation
+
+/////////////////////////////////////////////////////////////////////////////
+// local prototypes
+/////////////////////////////////////////////////////////////////////////////
+int Tune_Deviation(unsigned int index, long restX, long restY, long restZ);
+
+/////////////////////////////////////////////////////////////////////////////
+// library variables
+/////////////////////////////////////////////////////////////////////////////
+int TuneSamples[TUNE_MAX_SAMPLES][3]; // x, y, z for each sample in the window
+unsigned int TuneSampleCount = 0;
+
+unsigned char TuneNextProfile = 0; // profile the next recorded result belongs to
+int TuneSelected = -1;             // most aggressive profile that has settled so far
+
+/////////////////////////////////////////////////////////////////////////////
+// constants
+/////////////////////////////////////////////////////////////////////////////
+
+// candidate profiles from gentlest to most aggressive
+// shorter cruise periods move faster, bigger ramp steps accelerate harder
+const Tune_Profile TuneProfiles[] = {
+    {2000, 800, 2},
+    {2000, 600, 4},
+    {2000, 400, 6},
+    {1500, 300, 8},
+    {1500, 250, 12},
+    {1000, 200, 16},
+    {1000, 150, 24},
+    {800, 120, 32},
+    {600, 100, 48}};
+
+/////////////////////////////////////////////////////////////////////////////
+// function implementations
+/////////////////////////////////////////////////////////////////////////////
+
+// number of candidate profiles, ordered from gentlest to most aggressive
+unsigned char Tune_ProfileCount(void)
+{
+    return sizeof(TuneProfiles) / sizeof(TuneProfiles[0]);
+}
+
+// returns the candidate profile at the index (clamped to the last profile)
+Tune_Profile Tune_GetProfile(unsigned char index)
+{
+    if (index >= Tune_ProfileCount())
+        index = Tune_ProfileCount() - 1;
+    return TuneProfiles[index];
+}
+
+// clear the samples for a new test move
+void Tune_Reset(void)
+{
+    TuneSampleCount = 0;
+}
+
+// add one accelerometer sample
+// returns 0 if stored, -1 if the window is already full
+int Tune_AddSample(int x, int y, int z)
+{
+    if (TuneSampleCount >= TUNE_MAX_SAMPLES)
+        return -1;
+
+    TuneSamples[TuneSampleCount][0] = x;
+    TuneSamples[TuneSampleCount][1] = y;
+    TuneSamples[TuneSampleCount][2] = z;
+    ++TuneSampleCount;
+    return 0;
+}
+
+// number of samples in the window
+unsigned int Tune_SampleCount(void)
+{
+    return TuneSampleCount;
+}
+
+// copy out the sample at the index
+// returns 0 if copied, -1 if the index is past the end of the window
+int Tune_GetSample(unsigned int index, int *pX, int *pY, int *pZ)
+{
+    if (index >= TuneSampleCount)
+        return -1;
+
+    *pX = TuneSamples[index][0];
+    *pY = TuneSamples[index][1];
+    *pZ = TuneSamples[index][2];
+    return 0;
+}
+
+// number of samples before the effector settled to within tolerance of its at-rest reading
+// the at-rest reading is the average of the last TUNE_REST_SAMPLES samples, so if those are
+// still moving by more than the tolerance the effector never settled in the window
+unsigned int Tune_SettleSamples(int tolerance)
+{
+    long restX = 0, restY = 0, restZ = 0;
+    unsigned int i;
+
+    // not enough samples for a rest reference plus something to compare against it
+    if (TuneSampleCount <= TUNE_REST_SAMPLES)
+        return TuneSampleCount;
+
+    // average the end of the window as the at-rest reading
+    for (i = TuneSampleCount - TUNE_REST_SAMPLES; i < TuneSampleCount; ++i)
+    {
+        restX += TuneSamples[i][0];
+        restY += TuneSamples[i][1];
+        restZ += TuneSamples[i][2];
+    }
+    restX /= TUNE_REST_SAMPLES;
+    restY /= TUNE_REST_SAMPLES;
+    restZ /= TUNE_REST_SAMPLES;
+
+    // the effector settled after the last sample outside the tolerance
+    for (i = TuneSampleCount; i > 0; --i)
+    {
+        if (Tune_Deviation(i - 1, restX, restY, restZ) > tolerance)
+        {
+            // still moving inside the rest window - never settled
+            if (i > TuneSampleCount - TUNE_REST_SAMPLES)
+                return TuneSampleCount;
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+// start a new search from the gentlest profile
+void Tune_StartSearch(void)
+{
+    TuneNextProfile = 0;
+    TuneSelected = -1;
+}
+
+// record the result of the test move for the next profile in the search
+// returns 1 if the search should continue with the next profile, 0 if it is finished
+unsigned char Tune_RecordResult(unsigned int settleSamples, unsigned int maxSettleSamples)
+{
+    // more aggressive profiles only vibrate more, so stop at the first one that fails
+    if (settleSamples > maxSettleSamples)
+        return 0;
+
+    TuneSelected = TuneNextProfile;
+    return ++TuneNextProfile < Tune_ProfileCount();
+}
+
+// index of the selected profile, or -1 if even the gentlest profile failed to settle
+int Tune_SelectedProfile(void)
+{
+    return TuneSelected;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Hidden Helpers (local to implementation only)
+/////////////////////////////////////////////////////////////////////////////
+
+// largest single axis difference between a sample and the rest reading
+int Tune_Deviation(unsigned int index, long restX, long restY, long restZ)
+{
+    long dev = TuneSamples[index][0] - restX;
+    long devY = TuneSamples[index][1] - restY;
+    long devZ = TuneSamples[index][2] - restZ;
+
+    if (dev < 0)
+        dev = -dev;
+    if (devY < 0)
+        devY = -devY;
+    if (devZ < 0)
+        devZ = -devZ;
+
+    if (devY > dev)
+        dev = devY;
+    if (devZ > dev)
+        dev = devZ;
+    return (int)dev;
+}
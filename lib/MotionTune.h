@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////////////
+// Processor:     MC9S12XDP512 (also builds on a PC, no hardware access)
+// Bus Speed:     20 MHz (Requires Active PLL)
+// Author:        Andrew Belter
+// Created:       Oct. 19, 2026
+// Details:       Residual vibration analysis for tuning the effector motion profile.
+//                Accelerometer samples taken after a test move are collected here and
+//                checked for how quickly they settle. No hardware access, so the same
+//                analysis can be replayed on a PC against recorded samples.
+/////////////////////////////////////////////////////////////////////////////
+
+// most samples kept per test move
+#define TUNE_MAX_SAMPLES 128
+
+// samples at the end of the window averaged as the at-rest reference
+#define TUNE_REST_SAMPLES 16
+
+/////////////////////////////////////////////////////////////////////////////
+// Types
+/////////////////////////////////////////////////////////////////////////////
+
+// one motion profile candidate (see Cap_SetMotionProfile)
+typedef struct Tune_Profile
+{
+    unsigned int startPeriod_us;
+    unsigned int cruisePeriod_us;
+    unsigned int rampStep_us;
+} Tune_Profile;
+
+/////////////////////////////////////////////////////////////////////////////
+// Library Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+// number of candidate profiles, ordered from gentlest to most aggressive
+unsigned char Tune_ProfileCount(void);
+
+// returns the candidate profile at the index (clamped to the last profile)
+Tune_Profile Tune_GetProfile(unsigned char index);
+
+// clear the samples for a new test move
+void Tune_Reset(void);
+
+// add one accelerometer sample (any consistent units)
+// returns 0 if stored, -1 if the window is already full
+int Tune_AddSample(int x, int y, int z);
+
+// number of samples in the window
+unsigned int Tune_SampleCount(void);
+
+// copy out the sample at the index (for streaming/recording the window)
+// returns 0 if copied, -1 if the index is past the end of the window
+int Tune_GetSample(unsigned int index, int *pX, int *pY, int *pZ);
+
+// number of samples before the effector settled to within tolerance of its at-rest reading
+// (every sample after this one is within tolerance on all axes)
+// returns the sample count if it never settled or there are not enough samples to tell
+unsigned int Tune_SettleSamples(int tolerance);
+
+// tracks the search over the candidate profiles, one result per test move in profile order
+// the selection is the most aggressive profile before the first one that failed to settle
+// within maxSettleSamples
+void Tune_StartSearch(void);
+
+// record the result of the test move for the next profile in the search
+// returns 1 if the search should continue with the next profile, 0 if it is finished
+unsigned char Tune_RecordResult(unsigned int settleSamples, unsigned int maxSettleSamples);
+
+// index of the selected profile, or -1 if even the gentlest profile failed to settle
+int Tune_SelectedProfile(void);
+
+/////////////////////////////////////////////////////////////////////////////
+// Hidden Helpers (local to implementation only)
+/////////////////////////////////////////////////////////////////////////////
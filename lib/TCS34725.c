@@ -0,0 +1,134 @@
+/////////////////////////////////////////////////////////////////////////////
+// Processor:     MC9S12XDP512
+// Bus Speed:     20 MHz (Requires Active PLL)
+// Author:        Andrew Belter
+// Created:       Oct. 19, 2026
+// Details:       Library for using the TCS34725 colour sensor over I2C.
+//                Only uses the I2C library, so it also builds on a PC against a stand-in
+//                for i2c.c (see ChipColourReplay).
+// Revision History
+//      each revision will have a date + desc. of changes
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TCS34725.h"
+
+// other includes, as *required* for this implementation
+#include "i2c.h"
+
+/////////////////////////////////////////////////////////////////////////////
+// local prototypes
+/////////////////////////////////////////////////////////////////////////////
+int TCS34725_WriteRegister(unsigned char reg, unsigned char value);
+unsigned int TCS34725_Word(unsigned char const *pLow);
+
+/////////////////////////////////////////////////////////////////////////////
+// library variables
+/////////////////////////////////////////////////////////////////////////////
+I2C_Transaction TCS34725_Xfer; // queued read, reused for every TCS34725_StartRead
+
+/////////////////////////////////////////////////////////////////////////////
+// constants
+/////////////////////////////////////////////////////////////////////////////
+
+// command byte (repeated byte type), ORed with the register address
+const unsigned char TCS34725_Command = 0x80;
+
+// STATUS register (0x13) with auto-increment, so the data registers follow it in one read
+const unsigned char TCS34725_StatusRegister = 0xA0 | 0x13;
+
+/////////////////////////////////////////////////////////////////////////////
+// function implementations
+/////////////////////////////////////////////////////////////////////////////
+int TCS34725_Init(TCS34725_IntTime intTime, TCS34725_Gain gain)
+{
+    unsigned char id = 0;
+
+    // read the ID register
+    if (I2C_SendAddressRW(TCS34725ADDR, I2C_WRITE, I2C_WAIT))
+        return -1;
+    (void)I2C_WriteByte(TCS34725_Command | 0x12, I2C_NOSTOP);
+    I2C_IssueRestart();
+    if (I2C_SendAddressRW(TCS34725ADDR, I2C_READ, I2C_NOWAIT))
+        return -1;
+    (void)I2C_RXByte(&id, I2C_NACK, I2C_STOP);
+
+    // 0x44 - TCS34721/TCS34725 (P22, datasheet)
+    if (id != 0x44)
+        return -1;
+
+    if (TCS34725_WriteRegister(0x01, (unsigned char)intTime)) // ATIME
+        return -1;
+    if (TCS34725_WriteRegister(0x0F, (unsigned char)gain)) // CONTROL
+        return -1;
+
+    // power on only, the oscillator needs to warm up before integrating
+    return TCS34725_WriteRegister(0x00, 0b00000001); // ENABLE - PON
+}
+
+int TCS34725_Enable(void)
+{
+    return TCS34725_WriteRegister(0x00, 0b00000011); // ENABLE - PON, AEN
+}
+
+int TCS34725_StartRead(unsigned char *pTarget)
+{
+    // the ISR is still filling the last target - leave its transaction alone
+    if (TCS34725_Xfer.status == I2C_Status_Pending)
+        return -1;
+
+    // write the status register with auto-increment, restart, read status + 8 data bytes
+    TCS34725_Xfer.address = TCS34725ADDR;
+    TCS34725_Xfer.pWrite = &TCS34725_StatusRegister;
+    TCS34725_Xfer.writeCount = 1;
+    TCS34725_Xfer.pRead = pTarget;
+    TCS34725_Xfer.readCount = TCS34725_READ_BYTES;
+
+    return I2C_Queue(&TCS34725_Xfer);
+}
+
+int TCS34725_ReadStatus(void)
+{
+    switch (TCS34725_Xfer.status)
+    {
+    case I2C_Status_Done:
+        return 0;
+    case I2C_Status_Pending:
+        I2C_QueueRetry(); // may be waiting for the bus
+        return 1;
+    default:
+        return -1;
+    }
+}
+
+int TCS34725_Unpack(unsigned char const *pRaw, unsigned int *pClear, unsigned int *pRed, unsigned int *pGreen, unsigned int *pBlue)
+{
+    // AVALID - the data registers hold a completed integration
+    if (!(pRaw[0] & 0x01))
+        return -1;
+
+    *pClear = TCS34725_Word(pRaw + 1);
+    *pRed = TCS34725_Word(pRaw + 3);
+    *pGreen = TCS34725_Word(pRaw + 5);
+    *pBlue = TCS34725_Word(pRaw + 7);
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Hidden Helpers (local to implementation only)
+/////////////////////////////////////////////////////////////////////////////
+
+// writes a single register (blocking)
+int TCS34725_WriteRegister(unsigned char reg, unsigned char value)
+{
+    if (I2C_SendAddressRW(TCS34725ADDR, I2C_WRITE, I2C_WAIT))
+        return -1;
+    (void)I2C_WriteByte(TCS34725_Command | reg, I2C_NOSTOP);
+    (void)I2C_WriteByte(value, I2C_STOP);
+    return 0;
+}
+
+// 16-bit data register value, low byte first
+unsigned int TCS34725_Word(unsigned char const *pLow)
+{
+    return ((unsigned int)pLow[1] << 8) | pLow[0];
+}
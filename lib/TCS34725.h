@@ -0,0 +1,67 @@
+/////////////////////////////////////////////
+// TCS34725 - RGB + Clear Colour Sensor Library
+// 7-bit device address 0x29, but 0x52 as command
+// this device can go to 400kHz
+/////////////////////////////////////////////
+
+// every register access starts with a command byte:
+// <1><TYPE1:TYPE0><A4:A0[Register]>
+// TYPE 00 - repeated byte (same register), 01 - auto-increment (multi-byte reads)
+
+// registers used here
+// 0x00 - ENABLE  (AEN bit 1 - RGBC enable, PON bit 0 - power on)
+// 0x01 - ATIME   (integration time, 256 - cycles of 2.4ms)
+// 0x0F - CONTROL (gain)
+// 0x12 - ID      (0x44 - TCS34721/TCS34725, 0x4D - TCS34723/TCS34727)
+// 0x13 - STATUS  (AVALID bit 0 - an integration has completed)
+// 0x14 - 0x1B    (clear, red, green, blue data, 16-bit, low byte first)
+// reading the low byte latches the high byte, so the channels are read in one auto-increment read
+
+// command form (8-bit) of address is 0x52 (0x29 << 1)
+#define TCS34725ADDR 0x52
+
+// wait after TCS34725_Init powers the device on, before TCS34725_Enable (P15, datasheet)
+#define TCS34725_WARMUP_US 2400
+
+// bytes read by TCS34725_StartRead - STATUS, then clear, red, green, blue (low byte first)
+#define TCS34725_READ_BYTES 9
+
+// integration times (ATIME register values), longer integrations count higher
+typedef enum TCS34725_IntTime
+{
+  TCS34725_IntTime_2_4ms = 0xFF, // max count 1024
+  TCS34725_IntTime_24ms = 0xF6,  // max count 10240
+  TCS34725_IntTime_50ms = 0xEB,  // max count 20480
+  TCS34725_IntTime_101ms = 0xD5, // max count 43008
+  TCS34725_IntTime_154ms = 0xC0  // max count 65535
+} TCS34725_IntTime;
+
+// analog gain (CONTROL register values)
+typedef enum TCS34725_Gain
+{
+  TCS34725_Gain_1x,
+  TCS34725_Gain_4x,
+  TCS34725_Gain_16x,
+  TCS34725_Gain_60x
+} TCS34725_Gain;
+
+// check the device ID, set the integration time and gain, and power on (blocking calls)
+// wait TCS34725_WARMUP_US, then TCS34725_Enable to start integrating
+// returns 0 on success, -1 if the device did not respond or is not a TCS34725
+int TCS34725_Init (TCS34725_IntTime intTime, TCS34725_Gain gain);
+
+// start continuous RGBC integration (blocking call)
+int TCS34725_Enable (void);
+
+// queued read of the status and the four channels, needs the I2C transaction queue running
+// requires target length of TCS34725_READ_BYTES
+// returns 0 if queued, -1 if the last queued read is still pending or the queue is full
+int TCS34725_StartRead (unsigned char * pTarget);
+
+// state of the last TCS34725_StartRead read
+// returns 0 when read, 1 while pending, -1 on error
+int TCS34725_ReadStatus (void);
+
+// unpack the bytes read by TCS34725_StartRead into the channel counts
+// returns 0 on success, -1 if no integration has completed since the device was enabled
+int TCS34725_Unpack (unsigned char const * pRaw, unsigned int * pClear, unsigned int * pRed, unsigned int * pGreen, unsigned int * pBlue);
@@ -9,6 +9,8 @@
 //      each revision will have a date + desc. of changes
 //      Nov. 23, 2022:   Implemented AtoD_Init and AtoD_Read.
 //                       Created AtoD_InterruptMode and AtoD_Channels enums.
+//      Oct. 19, 2026:   Added interrupt driven capture with per-channel running averages and min/max.
+//                       AtoD_Read returns AtoD_INVALID_READING for an invalid channel.
 /////////////////////////////////////////////////////////////////////////////
 
 #include <hidef.h>      /* common defines and macros */
@@ -26,6 +28,19 @@
 // library variables
 /////////////////////////////////////////////////////////////////////////////
 
+// ring buffer of the last AtoD_SAMPLE_COUNT samples for each channel, written by AtoD_Capture
+volatile unsigned int AtoD_Samples[8][AtoD_SAMPLE_COUNT];
+volatile unsigned char AtoD_SampleIndex = 0; // next slot to overwrite in every channel's ring
+
+// running sum of each channel's ring, kept up to date on capture so the average is one shift
+volatile unsigned int AtoD_Sums[8];
+
+// peak samples since init or the last clear
+volatile unsigned int AtoD_Mins[8];
+volatile unsigned int AtoD_Maxs[8];
+
+volatile unsigned int AtoD_Sequences = 0;
+
 /////////////////////////////////////////////////////////////////////////////
 // constants
 /////////////////////////////////////////////////////////////////////////////
@@ -38,6 +53,20 @@
 // assumes 20MHz bus rate
 void AtoD_Init(AtoD_InterruptMode intMode)
 {
+    unsigned char i, j;
+
+    // clear the sample buffers and peaks before any captures can happen
+    for (i = 0; i < 8; ++i)
+    {
+        for (j = 0; j < AtoD_SAMPLE_COUNT; ++j)
+            AtoD_Samples[i][j] = 0;
+        AtoD_Sums[i] = 0;
+        AtoD_Mins[i] = AtoD_INVALID_READING;
+        AtoD_Maxs[i] = 0;
+    }
+    AtoD_SampleIndex = 0;
+    AtoD_Sequences = 0;
+
     // power up the module, fast flag clearing on, run in Wait mode, no external trigger(5.3.2.3)
     ATD0CTL2 = 0b11000000;
 
@@ -45,7 +74,14 @@ void AtoD_Init(AtoD_InterruptMode intMode)
 
     ATD0CTL3 = 0b01000000; // scan all channels (5.3.2.4)
 
-    ATD0CTL4 = 0b00000100; // set the prescale to 4 (for 20MHz) (5.3.2.5)
+    if (intMode == AtoD_InterruptsOn)
+    {
+        // every sequence interrupts, so run the ATD clock at its 500kHz minimum with the longest
+        // sample time - a sequence then takes ~450us instead of ~60us, keeping the ISR load light
+        ATD0CTL4 = 0b01110011; // 16 clock sample time, prescale 19 (for 20MHz) (5.3.2.5)
+    }
+    else
+        ATD0CTL4 = 0b00000100; // set the prescale to 4 (for 20MHz) (5.3.2.5)
 
     // right-justified, unsigned results, continuous scan on multiple channels, starting at AN0 (5.3.2.6)
     ATD0CTL5 = 0b10110000;
@@ -75,7 +111,86 @@ unsigned int AtoD_Read(AtoD_Channels channel)
     case AtoD_Channel7:
         return ATD0DR7;
     }
-    
+
+    return AtoD_INVALID_READING;
+}
+
+// store the latest conversion sequence in the per-channel sample buffers
+// call from the ATD0 ISR only
+void AtoD_Capture(void)
+{
+    unsigned int results[8];
+    unsigned char i;
+
+    // read every result register (reading any clears the flag with fast flag clearing)
+    results[0] = ATD0DR0;
+    results[1] = ATD0DR1;
+    results[2] = ATD0DR2;
+    results[3] = ATD0DR3;
+    results[4] = ATD0DR4;
+    results[5] = ATD0DR5;
+    results[6] = ATD0DR6;
+    results[7] = ATD0DR7;
+
+    for (i = 0; i < 8; ++i)
+    {
+        // swap the oldest sample in the running sum for the new one
+        AtoD_Sums[i] += results[i] - AtoD_Samples[i][AtoD_SampleIndex];
+        AtoD_Samples[i][AtoD_SampleIndex] = results[i];
+
+        if (results[i] < AtoD_Mins[i])
+            AtoD_Mins[i] = results[i];
+        if (results[i] > AtoD_Maxs[i])
+            AtoD_Maxs[i] = results[i];
+    }
+
+    AtoD_SampleIndex = (AtoD_SampleIndex + 1) & (AtoD_SAMPLE_COUNT - 1);
+    ++AtoD_Sequences;
+}
+
+// average of the last AtoD_SAMPLE_COUNT captured sequences for the channel
+unsigned int AtoD_ReadAverage(AtoD_Channels channel)
+{
+    if (channel > AtoD_Channel7)
+        return AtoD_INVALID_READING;
+
+    // 10-bit samples, so a sum of up to 64 samples fits in 16 bits
+    return AtoD_Sums[channel] / AtoD_SAMPLE_COUNT;
+}
+
+// lowest captured sample for the channel since init or the last AtoD_ClearPeaks
+unsigned int AtoD_ReadMin(AtoD_Channels channel)
+{
+    if (channel > AtoD_Channel7)
+        return AtoD_INVALID_READING;
+
+    return AtoD_Mins[channel];
+}
+
+// highest captured sample for the channel since init or the last AtoD_ClearPeaks
+unsigned int AtoD_ReadMax(AtoD_Channels channel)
+{
+    if (channel > AtoD_Channel7)
+        return AtoD_INVALID_READING;
+
+    return AtoD_Maxs[channel];
+}
+
+// restart min/max tracking for the channel
+void AtoD_ClearPeaks(AtoD_Channels channel)
+{
+    if (channel > AtoD_Channel7)
+        return;
+
+    // a capture landing between these only leaves its sample out of one of the peaks
+    AtoD_Mins[channel] = AtoD_INVALID_READING;
+    AtoD_Maxs[channel] = 0;
+}
+
+// number of conversion sequences captured since init (wraps)
+unsigned int AtoD_SequenceCount(void)
+{
+    return AtoD_Sequences;
 }
 /////////////////////////////////////////////////////////////////////////////
 // Hidden Helpers (local to implementation only)
@@ -6,19 +6,12 @@
 // Details:       Initialize and read values from the AtoD module
 /////////////////////////////////////////////////////////////////////////////
 
-// ISR:
+// ISR (init with AtoD_InterruptsOn to use the filtered reads):
 /*
 interrupt VectorNumber_Vatd0 void INT_AD0 (void)
 {
- // read channel values (reading any clears interrupt flag)
- ADVal[0] = ATD0DR0;
- //ADVal[1] = ATD0DR1;
- //ADVal[2] = ATD0DR2;
- //ADVal[3] = ATD0DR3;
- //ADVal[4] = ATD0DR4;
- //ADVal[5] = ATD0DR5;
- //ADVal[6] = ATD0DR6;
- //ADVal[7] = ATD0DR7;
+ // capture the conversion sequence into the sample buffers (reading the results clears the interrupt flag)
+ AtoD_Capture();
 }
 */
 
@@ -28,6 +21,12 @@ interrupt VectorNumber_Vatd0 void INT_AD0 (void)
     LCD_StringXY(0, 0, buffer);
 */
 
+// number of conversion sequences kept per channel for the running average (must be a power of 2)
+#define AtoD_SAMPLE_COUNT 8
+
+// returned by the read functions when the channel is not AtoD_Channel0-7
+#define AtoD_INVALID_READING 0xFFFF
+
 /////////////////////////////////////////////////////////////////////////////
 // Enumerations
 /////////////////////////////////////////////////////////////////////////////
@@ -56,11 +55,34 @@ typedef enum AtoD_Channels
 // initialized the AtoD0 module
 // assumes 20MHz bus rate
 // assumes interrupts are available on the A/D
+// with interrupts on, every conversion sequence is captured by AtoD_Capture (see ISR above)
 void AtoD_Init(AtoD_InterruptMode intMode);
 
-// read the desired channel, assumes fast flag clearing from init
+// read the latest raw conversion of the desired channel, assumes fast flag clearing from init
+// returns AtoD_INVALID_READING for an invalid channel
 unsigned int AtoD_Read(AtoD_Channels channel);
 
+// store the latest conversion sequence in the per-channel sample buffers
+// call from the ATD0 ISR only
+void AtoD_Capture(void);
+
+// average of the last AtoD_SAMPLE_COUNT captured sequences for the channel
+// (averages in zeros until AtoD_SAMPLE_COUNT sequences have been captured after init)
+// returns AtoD_INVALID_READING for an invalid channel
+unsigned int AtoD_ReadAverage(AtoD_Channels channel);
+
+// lowest/highest captured sample for the channel since init or the last AtoD_ClearPeaks
+// returns AtoD_INVALID_READING for an invalid channel
+unsigned int AtoD_ReadMin(AtoD_Channels channel);
+unsigned int AtoD_ReadMax(AtoD_Channels channel);
+
+// restart min/max tracking for the channel
+void AtoD_ClearPeaks(AtoD_Channels channel);
+
+// number of conversion sequences captured since init (wraps)
+// wait for this to change to be sure a filtered read includes a new sample
+unsigned int AtoD_SequenceCount(void);
+
 /////////////////////////////////////////////////////////////////////////////
 // Hidden Helpers (local to implementation only)
 /////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,7 @@
 //               Dec         2018 - complete unified front end for I2C + device functs 
 //               Nov      13 2019 - updated to use benefit of derivative defs (vs.code)
 //               Nov      30 2020 - updated to include 20MHz/8MHz clock parameterization 
+//               Oct      19 2026 - added interrupt driven transaction queue
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 // general theory for all I2C devices
@@ -39,12 +40,49 @@
 //  (we have it in use, it won't become free)
 // read as above
 
+// QUEUED:
+// the same sequences, but each byte is moved by the IIC0 ISR as the previous one
+//  completes, so the caller only queues the transaction and later checks its status
+// the ISR never waits for the bus - a transaction that finds it still busy (stop of
+//  the last one not yet on the wire) is left queued, and started by the foreground
+//  the next time it queues or polls (I2C_QueueRetry)
+
+
+// phase of the active queued transaction, advanced once per IIC0 interrupt
+typedef enum
+{
+  I2C_Phase_Idle,
+  I2C_Phase_WriteAddress, // address w/write sent, waiting for ack
+  I2C_Phase_WriteData,    // data byte sent, waiting for ack
+  I2C_Phase_ReadAddress,  // address w/read sent (start or restart), waiting for ack
+  I2C_Phase_ReadData,     // receiving bytes
+  I2C_Phase_WaitBus       // head transaction queued, waiting for the bus to free
+} I2C_Phase;
+
+// local prototypes for the queue
+void I2C_StartNext (void);
+void I2C_RetryWaiting (void);
+void I2C_Finish (I2C_Status status);
+
+// transaction queue (ring of caller-owned transactions), head is the active one
+I2C_Transaction * I2C_Queued[I2C_QUEUE_SIZE];
+volatile unsigned char I2C_QueueHead = 0;
+volatile unsigned char I2C_QueueCount = 0;
+volatile I2C_Phase I2C_ActivePhase = I2C_Phase_Idle;
+volatile unsigned char I2C_ActiveIndex = 0; // bytes moved so far in the active phase
+unsigned int I2C_BusRetries = 0;            // foreground retries of the waiting transaction
 
 // general init
 void I2C_Init0 (I2C_MicroBusRate eBus, I2C_BusRate eRate, int IntsOn)
 {
   IIC0_IBCR_IBEN = 0; // kill the bus (attempt to tear-down previous activity)
 
+  // anything left in the queue died with the bus
+  I2C_QueueHead = 0;
+  I2C_QueueCount = 0;
+  I2C_ActivePhase = I2C_Phase_Idle;
+  I2C_BusRetries = 0;
+
   // test and see if the data line of the bus is being held low, if so, attempt to toggle the clock line a bit
   //  this should 'shake-off' any lingering conversations that an external device will be waiting on
   if (!(PTJ & 0x40))
@@ -293,3 +331,216 @@ int I2C_RXByte (unsigned char * buff, unsigned char IssueAck, unsigned char Issu
   return 0; // good condition  
 }
 
+/////////////////////////////////////////////////////////////////////
+// interrupt driven transaction queue
+/////////////////////////////////////////////////////////////////////
+
+// queue a transaction, queued transactions run back to back in order from the IIC0 ISR
+// returns 0 if queued, -1 if the queue is full, the transaction is empty or already pending
+int I2C_Queue (I2C_Transaction * pXfer)
+{
+  if ((!pXfer->writeCount && !pXfer->readCount) || pXfer->status == I2C_Status_Pending)
+    return -1;
+
+  // hold off the ISR while the queue is modified (a pending flag fires once re-enabled)
+  IIC0_IBCR_IBIE = 0;
+
+  if (I2C_QueueCount >= I2C_QUEUE_SIZE)
+  {
+    IIC0_IBCR_IBIE = 1;
+    return -1;
+  }
+
+  pXfer->status = I2C_Status_Pending;
+  I2C_Queued[(I2C_QueueHead + I2C_QueueCount) & (I2C_QUEUE_SIZE - 1)] = pXfer;
+
+  // queue was empty, so nothing will interrupt to start this one - kick it off here
+  if (++I2C_QueueCount == 1)
+    I2C_StartNext();
+  else if (I2C_ActivePhase == I2C_Phase_WaitBus)
+    I2C_RetryWaiting();
+
+  IIC0_IBCR_IBIE = 1;
+  return 0;
+}
+
+// start the head transaction if it is waiting for the bus (foreground only)
+// call while polling a queued transaction's status, the ISR does not retry it
+void I2C_QueueRetry (void)
+{
+  if (I2C_ActivePhase != I2C_Phase_WaitBus)
+    return;
+
+  IIC0_IBCR_IBIE = 0;
+  if (I2C_ActivePhase == I2C_Phase_WaitBus)
+    I2C_RetryWaiting();
+  IIC0_IBCR_IBIE = 1;
+}
+
+// non-zero while any queued transaction has not completed
+int I2C_QueueBusy (void)
+{
+  I2C_QueueRetry();
+  return I2C_QueueCount != 0;
+}
+
+// advance the active transaction (call from the IIC0 ISR only)
+// follows the typical IIC interrupt routine flow chart (9.7.1.4)
+void I2C_Service (void)
+{
+  I2C_Transaction * pXfer = I2C_Queued[I2C_QueueHead];
+  byte junk; // necessary for rx starting dummy read
+
+  // clear interrupt flag
+  IIC0_IBSR_IBIF = 1;
+
+  // lost arbitration - module has already dropped to slave, clear it and fail the transaction
+  if (IIC0_IBSR_IBAL)
+  {
+    IIC0_IBSR_IBAL = 1;
+    if (I2C_ActivePhase != I2C_Phase_Idle)
+    {
+      I2C_Finish(I2C_Status_Error);
+      I2C_StartNext();
+    }
+    return;
+  }
+
+  switch (I2C_ActivePhase)
+  {
+  case I2C_Phase_Idle:
+  case I2C_Phase_WaitBus:
+    return; // nothing on the bus (stray flag)
+
+  case I2C_Phase_WriteAddress:
+  case I2C_Phase_WriteData:
+    // no ack on address or data, give up the bus
+    if (IIC0_IBSR_RXAK)
+    {
+      IIC0_IBCR_MS_SL = 0;
+      I2C_Finish(I2C_Status_Error);
+      break;
+    }
+
+    // more to write
+    if (I2C_ActiveIndex < pXfer->writeCount)
+    {
+      I2C_ActivePhase = I2C_Phase_WriteData;
+      IIC0_IBDR = pXfer->pWrite[I2C_ActiveIndex++];
+      return;
+    }
+
+    // write done, restart (bus stays hot) and announce the read
+    if (pXfer->readCount)
+    {
+      I2C_ActivePhase = I2C_Phase_ReadAddress;
+      IIC0_IBCR_RSTA = 1;
+      IIC0_IBDR = pXfer->address | 0x01;
+      return;
+    }
+
+    // write only, done
+    IIC0_IBCR_MS_SL = 0;
+    I2C_Finish(I2C_Status_Done);
+    break;
+
+  case I2C_Phase_ReadAddress:
+    if (IIC0_IBSR_RXAK)
+    {
+      IIC0_IBCR_MS_SL = 0;
+      I2C_Finish(I2C_Status_Error);
+      break;
+    }
+
+    // become a receiver, nack right away if only one byte is wanted (9.3.2.3)
+    I2C_ActiveIndex = 0;
+    I2C_ActivePhase = I2C_Phase_ReadData;
+    IIC0_IBCR_TX_RX = 0;
+    IIC0_IBCR_TXAK = pXfer->readCount == 1 ? 1 : 0;
+
+    // start read process
+    junk = IIC0_IBDR;
+    return;
+
+  case I2C_Phase_ReadData:
+    // stop before reading the last byte, nack before reading the second last
+    //  (reading the data register starts the next byte)
+    if (I2C_ActiveIndex == pXfer->readCount - 1)
+      IIC0_IBCR_MS_SL = 0;
+    else if (I2C_ActiveIndex == pXfer->readCount - 2)
+      IIC0_IBCR_TXAK = 1;
+
+    pXfer->pRead[I2C_ActiveIndex++] = IIC0_IBDR;
+
+    if (I2C_ActiveIndex < pXfer->readCount)
+      return;
+
+    I2C_Finish(I2C_Status_Done);
+    break;
+  }
+
+  // active transaction finished, move on to the next one (if any)
+  I2C_StartNext();
+}
+
+/////////////////////////////////////////////////////////////////////
+// queue helpers
+/////////////////////////////////////////////////////////////////////
+
+// start the transaction at the head of the queue (ISR, or foreground with IBIE off)
+// never waits for the bus - if it is still busy the transaction stays queued
+//  and is started by the next foreground retry
+void I2C_StartNext (void)
+{
+  I2C_Transaction * pXfer = I2C_Queued[I2C_QueueHead];
+
+  if (!I2C_QueueCount)
+  {
+    I2C_ActivePhase = I2C_Phase_Idle;
+    return;
+  }
+
+  // single master, so the bus frees within a stop condition of the last transaction
+  if (IIC0_IBSR_IBB)
+  {
+    I2C_ActivePhase = I2C_Phase_WaitBus;
+    return;
+  }
+
+  // got bus, master mode, transmitting (start)
+  I2C_BusRetries = 0;
+  I2C_ActiveIndex = 0;
+  IIC0_IBCR |= IIC0_IBCR_MS_SL_MASK | IIC0_IBCR_TX_RX_MASK;
+  if (pXfer->writeCount)
+  {
+    I2C_ActivePhase = I2C_Phase_WriteAddress;
+    IIC0_IBDR = pXfer->address & 0xFE; // send slave address w/write
+  }
+  else
+  {
+    I2C_ActivePhase = I2C_Phase_ReadAddress;
+    IIC0_IBDR = pXfer->address | 0x01; // send slave address w/read
+  }
+}
+
+// retry the head transaction waiting for the bus (foreground with IBIE off)
+// a bus that stays busy for I2C_SPIN_COUNTMAX retries fails the transaction, and the
+//  next one is tried
+void I2C_RetryWaiting (void)
+{
+  if (++I2C_BusRetries >= I2C_SPIN_COUNTMAX)
+  {
+    I2C_BusRetries = 0;
+    I2C_Finish(I2C_Status_Error);
+  }
+  I2C_StartNext();
+}
+
+// flag the active transaction with its final status and remove it from the queue
+void I2C_Finish (I2C_Status status)
+{
+  I2C_Queued[I2C_QueueHead]->status = status;
+  I2C_QueueHead = (I2C_QueueHead + 1) & (I2C_QUEUE_SIZE - 1);
+  --I2C_QueueCount;
+  I2C_ActivePhase = I2C_Phase_Idle;
+}
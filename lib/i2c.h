@@ -63,3 +63,55 @@ int I2C_RXByte (unsigned char * buff, unsigned char IssueAck, unsigned char Issu
 // issue a restart (some devices use this)
 void I2C_IssueRestart (void);
 // ***************************************************
+
+// interrupt driven transactions *********************
+// init with IntsOn and add the ISR below, then queue transactions instead of
+//  calling the blocking functions above (don't mix the two while the queue is busy)
+/*
+interrupt VectorNumber_Viic0 void ISR_IIC0 (void)
+{
+  I2C_Service();
+}
+*/
+
+// most transactions waiting in the queue at once, including the active one (power of 2)
+#define I2C_QUEUE_SIZE 8
+
+// completion flag for a queued transaction
+typedef enum
+{
+  I2C_Status_Idle,     // never queued
+  I2C_Status_Pending,  // queued or in progress
+  I2C_Status_Done,     // completed
+  I2C_Status_Error     // no ACK, lost arbitration or bus never freed (stop issued)
+} I2C_Status;
+
+// one transaction: address, write phase, then restart and read phase if both are given
+//  write only - register/DAC writes
+//  write + read - register reads (write register, restart, read)
+//  read only - plain reads
+// buffers belong to the caller and must stay valid until status leaves I2C_Status_Pending
+typedef struct
+{
+  unsigned char address;          // 8-bit device address (R/W bit is set by the engine)
+  unsigned char const * pWrite;   // bytes to write
+  unsigned char writeCount;
+  unsigned char * pRead;          // target for bytes read
+  unsigned char readCount;
+  volatile I2C_Status status;     // set by the ISR as the transaction completes
+} I2C_Transaction;
+
+// queue a transaction, queued transactions run back to back in order from the IIC0 ISR
+// returns 0 if queued, -1 if the queue is full, the transaction is empty or already pending
+int I2C_Queue (I2C_Transaction * pXfer);
+
+// non-zero while any queued transaction has not completed (also retries as below)
+int I2C_QueueBusy (void);
+
+// start the head transaction if it was left waiting for the bus to free
+//  (the ISR never waits for the bus) - call while polling a queued transaction's status
+void I2C_QueueRetry (void);
+
+// advance the active transaction (call from the IIC0 ISR only)
+void I2C_Service (void);
+// ***************************************************